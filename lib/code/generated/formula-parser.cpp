@@ -809,103 +809,103 @@ namespace Spreader { namespace FormulaParser {
 
   case 7: // expression: OP_ADD expression
 #line 87 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new AffirmNode         (std::move(yystack_[0].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new AffirmNode         (std::move(yystack_[0].value.as < AstNodePtr > ())))); }
 #line 814 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 8: // expression: OP_SUB expression
 #line 88 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new NegateNode         (std::move(yystack_[0].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new NegateNode         (std::move(yystack_[0].value.as < AstNodePtr > ())))); }
 #line 820 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 9: // expression: expression OP_POW expression
 #line 89 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new PowerNode          (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new PowerNode          (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ())))); }
 #line 826 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 10: // expression: expression OP_MUL expression
 #line 90 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new MultiplyNode       (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new MultiplyNode       (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ())))); }
 #line 832 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 11: // expression: expression OP_DIV expression
 #line 91 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new DivideNode         (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new DivideNode         (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ())))); }
 #line 838 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 12: // expression: expression OP_ADD expression
 #line 92 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new AddNode            (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new AddNode            (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ())))); }
 #line 844 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 13: // expression: expression PLUS_NUMERICAL_CONSTANT
 #line 93 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new AddNode            (std::move(yystack_[1].value.as < AstNodePtr > ()), AstNodePtr(new ScalarNode(yystack_[0].value.as < double > ())))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new AddNode            (std::move(yystack_[1].value.as < AstNodePtr > ()), AstNodePtr(new ScalarNode(yystack_[0].value.as < double > ()))))); }
 #line 850 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 14: // expression: expression OP_SUB expression
 #line 94 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new SubtractNode       (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new SubtractNode       (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ())))); }
 #line 856 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 15: // expression: expression MINUS_NUMERICAL_CONSTANT
 #line 95 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new SubtractNode       (std::move(yystack_[1].value.as < AstNodePtr > ()), AstNodePtr(new ScalarNode(yystack_[0].value.as < double > ())))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new SubtractNode       (std::move(yystack_[1].value.as < AstNodePtr > ()), AstNodePtr(new ScalarNode(yystack_[0].value.as < double > ()))))); }
 #line 862 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 16: // expression: expression OP_AMP expression
 #line 96 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new AmpersandNode      (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new AmpersandNode      (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ())))); }
 #line 868 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 17: // expression: expression OP_EQ expression
 #line 97 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new EqualsNode         (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new EqualsNode         (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ())))); }
 #line 874 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 18: // expression: expression OP_NE expression
 #line 98 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new NotEqualsNode      (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new NotEqualsNode      (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ())))); }
 #line 880 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 19: // expression: expression OP_LT expression
 #line 99 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new LessNode           (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new LessNode           (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ())))); }
 #line 886 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 20: // expression: expression OP_LE expression
 #line 100 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new LessEqualsNode     (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new LessEqualsNode     (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ())))); }
 #line 892 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 21: // expression: expression OP_GT expression
 #line 101 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new GreaterNode        (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new GreaterNode        (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ())))); }
 #line 898 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 22: // expression: expression OP_GE expression
 #line 102 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new GreaterEqualsNode  (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new GreaterEqualsNode  (std::move(yystack_[2].value.as < AstNodePtr > ()), std::move(yystack_[0].value.as < AstNodePtr > ())))); }
 #line 904 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 23: // expression: expression OP_PCT
 #line 103 "lib/code/src/formula.y"
-                                                { yylhs.value.as < AstNodePtr > () = AstNodePtr(new PercentNode        (std::move(yystack_[1].value.as < AstNodePtr > ()))); }
+                                                { yylhs.value.as < AstNodePtr > () = builder.fold(AstNodePtr(new PercentNode        (std::move(yystack_[1].value.as < AstNodePtr > ())))); }
 #line 910 "lib/code/generated/formula-parser.cpp"
     break;
 
@@ -915,55 +915,56 @@ namespace Spreader { namespace FormulaParser {
                                                   if (!func) {
                                                       YYERROR;
                                                   }
-                                                  yylhs.value.as < AstNodePtr > () = std::move(func);
+                                                  builder.onFunction(yystack_[2].value.as < FunctionId > ());
+                                                  yylhs.value.as < AstNodePtr > () = builder.fold(std::move(func), yystack_[2].value.as < FunctionId > ());
                                                 }
-#line 921 "lib/code/generated/formula-parser.cpp"
+#line 922 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 25: // scalar: ERROR_CONSTANT
-#line 114 "lib/code/src/formula.y"
+#line 115 "lib/code/src/formula.y"
                                                 { yylhs.value.as < Scalar > () = yystack_[0].value.as < Error > (); }
-#line 927 "lib/code/generated/formula-parser.cpp"
+#line 928 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 26: // scalar: LOGICAL_CONSTANT
-#line 115 "lib/code/src/formula.y"
+#line 116 "lib/code/src/formula.y"
                                                 { yylhs.value.as < Scalar > () = yystack_[0].value.as < bool > (); }
-#line 933 "lib/code/generated/formula-parser.cpp"
+#line 934 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 27: // scalar: PLUS_NUMERICAL_CONSTANT
-#line 116 "lib/code/src/formula.y"
+#line 117 "lib/code/src/formula.y"
                                                 { yylhs.value.as < Scalar > () = yystack_[0].value.as < double > (); }
-#line 939 "lib/code/generated/formula-parser.cpp"
+#line 940 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 28: // scalar: MINUS_NUMERICAL_CONSTANT
-#line 117 "lib/code/src/formula.y"
+#line 118 "lib/code/src/formula.y"
                                                 { yylhs.value.as < Scalar > () = -yystack_[0].value.as < double > (); }
-#line 945 "lib/code/generated/formula-parser.cpp"
+#line 946 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 29: // scalar: NUMERICAL_CONSTANT
-#line 118 "lib/code/src/formula.y"
+#line 119 "lib/code/src/formula.y"
                                                 { yylhs.value.as < Scalar > () = yystack_[0].value.as < double > (); }
-#line 951 "lib/code/generated/formula-parser.cpp"
+#line 952 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 30: // scalar: ROW
-#line 119 "lib/code/src/formula.y"
+#line 120 "lib/code/src/formula.y"
                                                 { yylhs.value.as < Scalar > () = double(yystack_[0].value.as < SizeType > () + 1); }
-#line 957 "lib/code/generated/formula-parser.cpp"
+#line 958 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 31: // scalar: STRING_CONSTANT
-#line 120 "lib/code/src/formula.y"
+#line 121 "lib/code/src/formula.y"
                                                 { yylhs.value.as < Scalar > () = std::move(yystack_[0].value.as < String > ()); }
-#line 963 "lib/code/generated/formula-parser.cpp"
+#line 964 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 32: // array: '{' array_columns '}'
-#line 125 "lib/code/src/formula.y"
+#line 126 "lib/code/src/formula.y"
                                                 {  
                                                     const Size size{SizeType(yystack_[1].value.as < std::vector<std::vector<Scalar>> > ()[0].size()), SizeType(yystack_[1].value.as < std::vector<std::vector<Scalar>> > ().size())};
                                                     std::vector<std::vector<Scalar>> & src = yystack_[1].value.as < std::vector<std::vector<Scalar>> > ();
@@ -975,17 +976,17 @@ namespace Spreader { namespace FormulaParser {
                                                     });
                                                     yylhs.value.as < AstNodePtr > () = AstNodePtr(new ArrayNode(std::move(arr)));
                                                 }
-#line 979 "lib/code/generated/formula-parser.cpp"
+#line 980 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 33: // array_columns: array_row
-#line 139 "lib/code/src/formula.y"
+#line 140 "lib/code/src/formula.y"
                                                 { yylhs.value.as < std::vector<std::vector<Scalar>> > ().emplace_back(std::move(yystack_[0].value.as < std::vector<Scalar> > ())); }
-#line 985 "lib/code/generated/formula-parser.cpp"
+#line 986 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 34: // array_columns: array_columns ';' array_row
-#line 140 "lib/code/src/formula.y"
+#line 141 "lib/code/src/formula.y"
                                                 { 
                                                     if (yystack_[2].value.as < std::vector<std::vector<Scalar>> > ()[0].size() != yystack_[0].value.as < std::vector<Scalar> > ().size()) {
                                                         error("row dimensions mismatch");
@@ -994,119 +995,119 @@ namespace Spreader { namespace FormulaParser {
                                                     yystack_[2].value.as < std::vector<std::vector<Scalar>> > ().emplace_back(std::move(yystack_[0].value.as < std::vector<Scalar> > ()));
                                                     yylhs.value.as < std::vector<std::vector<Scalar>> > () = std::move(yystack_[2].value.as < std::vector<std::vector<Scalar>> > ());
                                                 }
-#line 998 "lib/code/generated/formula-parser.cpp"
+#line 999 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 35: // array_row: scalar
-#line 152 "lib/code/src/formula.y"
+#line 153 "lib/code/src/formula.y"
                                                 { yylhs.value.as < std::vector<Scalar> > ().emplace_back(std::move(yystack_[0].value.as < Scalar > ())); }
-#line 1004 "lib/code/generated/formula-parser.cpp"
+#line 1005 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 36: // array_row: array_row ',' scalar
-#line 153 "lib/code/src/formula.y"
+#line 154 "lib/code/src/formula.y"
                                                 { yystack_[2].value.as < std::vector<Scalar> > ().emplace_back(std::move(yystack_[0].value.as < Scalar > ())); yylhs.value.as < std::vector<Scalar> > () = std::move(yystack_[2].value.as < std::vector<Scalar> > ()); }
-#line 1010 "lib/code/generated/formula-parser.cpp"
+#line 1011 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 37: // row: ROW
-#line 160 "lib/code/src/formula.y"
+#line 161 "lib/code/src/formula.y"
                                                 { yylhs.value.as < ReferenceTypeAndValue > () = ReferenceTypeAndValue{ReferenceType::Relative, yystack_[0].value.as < SizeType > () - builder.evalPoint().y}; }
-#line 1016 "lib/code/generated/formula-parser.cpp"
+#line 1017 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 38: // row: '$' ROW
-#line 161 "lib/code/src/formula.y"
+#line 162 "lib/code/src/formula.y"
                                                 { yylhs.value.as < ReferenceTypeAndValue > () = ReferenceTypeAndValue{ReferenceType::Absolute, yystack_[0].value.as < SizeType > ()}; }
-#line 1022 "lib/code/generated/formula-parser.cpp"
+#line 1023 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 39: // column: COLUMN
-#line 166 "lib/code/src/formula.y"
+#line 167 "lib/code/src/formula.y"
                                                 { yylhs.value.as < ReferenceTypeAndValue > () = ReferenceTypeAndValue{ReferenceType::Relative, yystack_[0].value.as < SizeType > () - builder.evalPoint().x}; }
-#line 1028 "lib/code/generated/formula-parser.cpp"
+#line 1029 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 40: // column: '$' COLUMN
-#line 167 "lib/code/src/formula.y"
+#line 168 "lib/code/src/formula.y"
                                                 { yylhs.value.as < ReferenceTypeAndValue > () = ReferenceTypeAndValue{ReferenceType::Absolute, yystack_[0].value.as < SizeType > ()}; }
-#line 1034 "lib/code/generated/formula-parser.cpp"
+#line 1035 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 41: // column: OUT_OF_RANGE_COLUMN
-#line 168 "lib/code/src/formula.y"
+#line 169 "lib/code/src/formula.y"
                                                 { error("column out of range"); YYERROR; }
-#line 1040 "lib/code/generated/formula-parser.cpp"
+#line 1041 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 42: // column: '$' OUT_OF_RANGE_COLUMN
-#line 169 "lib/code/src/formula.y"
+#line 170 "lib/code/src/formula.y"
                                                 { error("column out of range"); YYERROR; }
-#line 1046 "lib/code/generated/formula-parser.cpp"
+#line 1047 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 43: // cell_reference: column row
-#line 174 "lib/code/src/formula.y"
+#line 175 "lib/code/src/formula.y"
                                                 { auto idx = builder.addReference(CellReference(yystack_[1].value.as < ReferenceTypeAndValue > (), yystack_[0].value.as < ReferenceTypeAndValue > ()));   
                                                   yylhs.value.as < AstNodePtr > () = AstNodePtr(new ReferenceNode(idx)); }
-#line 1053 "lib/code/generated/formula-parser.cpp"
+#line 1054 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 44: // cell_reference: column ':' column
-#line 176 "lib/code/src/formula.y"
+#line 177 "lib/code/src/formula.y"
                                                 { auto idx = builder.addReference(ColumnReference(yystack_[2].value.as < ReferenceTypeAndValue > (), yystack_[0].value.as < ReferenceTypeAndValue > ())); 
                                                   yylhs.value.as < AstNodePtr > () = AstNodePtr(new ReferenceNode(idx)); }
-#line 1060 "lib/code/generated/formula-parser.cpp"
+#line 1061 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 45: // cell_reference: row ':' row
-#line 178 "lib/code/src/formula.y"
+#line 179 "lib/code/src/formula.y"
                                                 { auto idx = builder.addReference(RowReference(yystack_[2].value.as < ReferenceTypeAndValue > (), yystack_[0].value.as < ReferenceTypeAndValue > ()));    
                                                   yylhs.value.as < AstNodePtr > () = AstNodePtr(new ReferenceNode(idx)); }
-#line 1067 "lib/code/generated/formula-parser.cpp"
+#line 1068 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 46: // cell_reference: column row ':' column row
-#line 180 "lib/code/src/formula.y"
+#line 181 "lib/code/src/formula.y"
                                                 { auto idx = builder.addReference(AreaReference(yystack_[4].value.as < ReferenceTypeAndValue > (), yystack_[3].value.as < ReferenceTypeAndValue > (), yystack_[1].value.as < ReferenceTypeAndValue > (), yystack_[0].value.as < ReferenceTypeAndValue > ())); 
                                                   yylhs.value.as < AstNodePtr > () = AstNodePtr(new ReferenceNode(idx)); }
-#line 1074 "lib/code/generated/formula-parser.cpp"
+#line 1075 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 47: // argument_list: %empty
-#line 188 "lib/code/src/formula.y"
+#line 189 "lib/code/src/formula.y"
                                                 {  }
-#line 1080 "lib/code/generated/formula-parser.cpp"
+#line 1081 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 48: // argument_list: expression
-#line 189 "lib/code/src/formula.y"
+#line 190 "lib/code/src/formula.y"
                                                 { yylhs.value.as < ArgumentList > ().add(std::move(yystack_[0].value.as < AstNodePtr > ())); }
-#line 1086 "lib/code/generated/formula-parser.cpp"
+#line 1087 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 49: // argument_list: argument_list ','
-#line 190 "lib/code/src/formula.y"
+#line 191 "lib/code/src/formula.y"
                                                 { yylhs.value.as < ArgumentList > ().add(std::move(yystack_[1].value.as < ArgumentList > ()));
                                                   if (yylhs.value.as < ArgumentList > ().size() == 0)
                                                       yylhs.value.as < ArgumentList > ().add(AstNodePtr(new ScalarNode(Scalar::Blank{})));
                                                   yylhs.value.as < ArgumentList > ().add(AstNodePtr(new ScalarNode(Scalar::Blank{})));
                                                 }
-#line 1096 "lib/code/generated/formula-parser.cpp"
+#line 1097 "lib/code/generated/formula-parser.cpp"
     break;
 
   case 50: // argument_list: argument_list ',' expression
-#line 195 "lib/code/src/formula.y"
+#line 196 "lib/code/src/formula.y"
                                                 { yylhs.value.as < ArgumentList > ().add(std::move(yystack_[2].value.as < ArgumentList > ()));
                                                   if (yylhs.value.as < ArgumentList > ().size() == 0)
                                                       yylhs.value.as < ArgumentList > ().add(AstNodePtr(new ScalarNode(Scalar::Blank{})));
                                                   yylhs.value.as < ArgumentList > ().add(std::move(yystack_[0].value.as < AstNodePtr > ()));
                                                 }
-#line 1106 "lib/code/generated/formula-parser.cpp"
+#line 1107 "lib/code/generated/formula-parser.cpp"
     break;
 
 
-#line 1110 "lib/code/generated/formula-parser.cpp"
+#line 1111 "lib/code/generated/formula-parser.cpp"
 
             default:
               break;
@@ -1453,10 +1454,10 @@ namespace Spreader { namespace FormulaParser {
   {
        0,    79,    79,    83,    84,    85,    86,    87,    88,    89,
       90,    91,    92,    93,    94,    95,    96,    97,    98,    99,
-     100,   101,   102,   103,   104,   114,   115,   116,   117,   118,
-     119,   120,   125,   139,   140,   152,   153,   160,   161,   166,
-     167,   168,   169,   174,   176,   178,   180,   188,   189,   190,
-     195
+     100,   101,   102,   103,   104,   115,   116,   117,   118,   119,
+     120,   121,   126,   140,   141,   153,   154,   161,   162,   167,
+     168,   169,   170,   175,   177,   179,   181,   189,   190,   191,
+     196
   };
 
   void
@@ -1489,9 +1490,9 @@ namespace Spreader { namespace FormulaParser {
 
 #line 10 "lib/code/src/formula.y"
 } } // Spreader::FormulaParser
-#line 1493 "lib/code/generated/formula-parser.cpp"
+#line 1494 "lib/code/generated/formula-parser.cpp"
 
-#line 203 "lib/code/src/formula.y"
+#line 204 "lib/code/src/formula.y"
 
 
 void Spreader::FormulaParser::Parser::error(const std::string & ) {
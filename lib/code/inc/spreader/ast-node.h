@@ -19,12 +19,14 @@ namespace Spreader {
 
     class CellGrid;
     class FormulaCell;
+    class BytecodeBuilder;
     struct ExecutionContext;
 
     class AstNode 
     {
     friend std::default_delete<AstNode>;
     friend class ArgumentList;
+    friend class FoldedNode;
 
     public:
         using ExecutionMemoryResource = StackMemoryResource<4096>;
@@ -120,10 +122,15 @@ namespace Spreader {
             { return m_bracketed; }
 
         virtual auto execute(ExecutionContext & context) const -> bool = 0;
+        ///Emits bytecode equivalent to execute() if possible. Returns false if the node cannot be compiled.
+        virtual auto compile(BytecodeBuilder & builder) const -> bool;
         
         virtual void reconstructPrefix(const ReconstructionContext & context, StringBuilder & dest) const;
         virtual void reconstructSuffix(const ReconstructionContext & context, StringBuilder & dest) const;
 
+        ///Appends the text of this node and its children
+        void reconstruct(const ReconstructionContext & context, StringBuilder & dest) const;
+
     protected:
         void destroyChildren() noexcept;
 
@@ -153,6 +160,7 @@ namespace Spreader {
         }
 
         auto execute(ExecutionContext & context) const -> bool override;
+        auto compile(BytecodeBuilder & builder) const -> bool override;
         
         void reconstructPrefix(const ReconstructionContext & context, StringBuilder & dest) const override;
     private:
@@ -187,6 +195,7 @@ namespace Spreader {
         {}
 
         auto execute(ExecutionContext & context) const -> bool override;
+        auto compile(BytecodeBuilder & builder) const -> bool override;
         
         void reconstructPrefix(const ReconstructionContext & context, StringBuilder & dest) const override;
     private:
@@ -205,6 +214,7 @@ namespace Spreader {
         }
 
         auto execute(ExecutionContext & context) const -> bool override;
+        auto compile(BytecodeBuilder & builder) const -> bool override;
         
         void reconstructPrefix(const ReconstructionContext & context, StringBuilder & dest) const override;
     private:
@@ -215,6 +225,36 @@ namespace Spreader {
         String m_originalText;
     };
 
+    /**
+     Constant subexpression evaluated at parse time. 
+     
+     The original expression is kept, outside of the tree, only to reconstruct the formula text.
+     */
+    class FoldedNode final : public AstNode {
+
+    public:
+        FoldedNode(ScalarGenerator && value, Size extent, AstNodePtr && original) noexcept:
+            m_value(std::move(value)),
+            m_extent(extent),
+            m_original(std::move(original)) {
+        }
+
+        ///Replaces folded children of the node with their original expressions
+        static void unfoldChildren(AstNode & node) noexcept;
+
+        auto execute(ExecutionContext & context) const -> bool override;
+        auto compile(BytecodeBuilder & builder) const -> bool override;
+        
+        void reconstructPrefix(const ReconstructionContext & context, StringBuilder & dest) const override;
+    private:
+        ~FoldedNode() noexcept = default;
+
+    private:
+        const ScalarGenerator m_value;
+        const Size m_extent;
+        AstNodePtr m_original;
+    };
+
     class ArgumentList {
 
     public:
@@ -0,0 +1,129 @@
+// Copyright (c) 2022, Eugene Gershnik
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef SPR_HEADER_BYTECODE_H_INCLUDED
+#define SPR_HEADER_BYTECODE_H_INCLUDED
+
+#include <spreader/scalar.h>
+#include <spreader/formula-references.h>
+
+#include <vector>
+
+namespace Spreader {
+
+    class AstNode;
+    class BytecodeBuilder;
+    struct ExecutionContext;
+
+    /**
+     Flat compiled form of simple formulas.
+
+     Formulas that only combine constants and single cell references via operators, IF and CHOOSE
+     always produce a single scalar. For these the AST traversal, with its per-node stack entries,
+     is replaced by a postfix program over a small value stack. Anything else is not compiled and
+     is evaluated via the AST as usual.
+     */
+    class Bytecode {
+    friend BytecodeBuilder;
+    public:
+        enum class OpCode : uint8_t {
+            PushConstant,   //operand: index of the constant
+            PushReference,  //operand: index of the reference which must be a cell or an illegal one
+
+            Negate,
+            Affirm,
+            Percent,
+
+            Add,
+            Subtract,
+            Multiply,
+            Divide,
+            Power,
+            Ampersand,
+            Equals,
+            NotEquals,
+            Greater,
+            GreaterEquals,
+            Less,
+            LessEquals,
+
+            //Branches pop the selector value and continue at one of the following operand + 1 Jump instructions.
+            //The last one is taken with the result already pushed when the selector is invalid.
+            If,             //operand: 2
+            Choose,         //operand: number of choices
+
+            Jump            //operand: target instruction index
+        };
+
+        struct Instruction {
+            OpCode code;
+            uint32_t operand;
+        };
+
+        static constexpr size_t maxStackDepth = 16;
+
+    public:
+        Bytecode() noexcept = default;
+
+        ///Compiles the formula root. Returns empty bytecode if the formula is not simple enough
+        static auto compile(const AstNode & root, const FormulaReferences * refs) -> Bytecode;
+
+        auto empty() const noexcept -> bool
+            { return m_code.empty(); }
+
+        /**
+         Evaluates the program storing the value in result.
+
+         Returns false if a cell it reads needs to be recalculated first or is a circular dependency
+         (in which case context.circularDependency is set). The program has no state so it is simply
+         run again once the dependency is available.
+         */
+        auto run(ExecutionContext & context, Scalar & result) const -> bool;
+
+    private:
+        ///Returns the index of the jump to take. For the last one the selector is replaced by the result.
+        static auto selectBranch(const Instruction & instruction, Scalar & selector) -> uint32_t;
+
+    private:
+        std::vector<Instruction> m_code;
+        std::vector<Scalar> m_constants;
+    };
+
+    class BytecodeBuilder {
+    friend Bytecode;
+    public:
+        auto references() const noexcept -> const FormulaReferences *
+            { return m_references; }
+
+        auto add(const AstNode & node) -> bool;
+
+        void addConstant(const Scalar & value);
+        void addReference(size_t refIndex);
+        void addOperator(Bytecode::OpCode code);
+
+        ///Adds the selector node followed by a branch for each of its count next siblings
+        auto addBranches(Bytecode::OpCode code, const AstNode & selector, size_t count) -> bool;
+
+    private:
+        BytecodeBuilder(const FormulaReferences * refs) noexcept:
+            m_references(refs)
+        {}
+
+        void emit(Bytecode::OpCode code, uint32_t operand = 0)
+            { m_result.m_code.push_back({code, operand}); }
+        void push();
+        void pop(size_t count)
+            { m_depth -= count; }
+
+    private:
+        Bytecode m_result;
+        const FormulaReferences * m_references;
+        size_t m_depth = 0;
+        size_t m_nesting = 0;
+        bool m_tooDeep = false;
+
+        static constexpr size_t s_maxNesting = 64;
+    };
+}
+
+#endif
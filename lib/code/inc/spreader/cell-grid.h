@@ -7,11 +7,13 @@
 #include <spreader/error-handling.h>
 #include <spreader/geometry.h>
 #include <spreader/cell.h>
+#include <spreader/coro-generator.h>
 
 #include <numeric>
 #include <limits>
 #include <cstring>
 #include <array>
+#include <vector>
 
 namespace Spreader {
 
@@ -21,7 +23,7 @@ namespace Spreader {
         inline static constexpr Size s_sizePowers[] = {
             Size{4, 10}, // 2^14 =>  16kB *  sizeof(void *) = 128kb(64bit)
             Size{4, 10},
-            Size{8, 11}  // 2^19 => 0.5MB * sizeof(void *) = 4MB(64bit)
+            Size{8, 11}  // 2^19 => 0.5MB * sizeof(CellRef) = 4MB
         };
         inline static constexpr unsigned s_maxLevel = static_cast<unsigned>(std::size(s_sizePowers)) - 1;
         
@@ -70,6 +72,16 @@ namespace Spreader {
             return Eraser<Mover>{std::forward<Mover>(tr)};
         }
 
+        ///Adapts an op taking cell coordinates to the chunk offsets leaf tiles provide
+        template<class Op>
+        struct PositionedOp {
+            constexpr auto modifiesMissing() -> bool { return std::forward<Op>(op).modifiesMissing(); }
+            auto operator()(CellPtr & cell, Size offset) -> int { return std::forward<Op>(op)(cell, origin + offset); }
+
+            Op && op;
+            Point origin;
+        };
+
         template<class Transform>
         struct TransformAsGetter {
 
@@ -96,11 +108,152 @@ namespace Spreader {
             return TransformAsSetter<Transform>{std::forward<Transform>(tr)};
         }
 
+        /**
+         Cells of a leaf tile.
+         
+         A dense leaf is an array of 2^19 slots (4MB) which is wasteful for the few scattered
+         cells typical of most sheets. Leaves therefore start as a vector of (index, cell) pairs sorted
+         by index and are only promoted to the dense array once they have more than s_maxSparseCount cells.
+         */
+        class LeafStorage {
+        public:
+            inline static constexpr size_t s_cellCount = (size_t(1) << (s_sizePowers[s_maxLevel].width + s_sizePowers[s_maxLevel].height));
+            inline static constexpr size_t s_maxSparseCount = 4096;
+
+        public:
+            LeafStorage() noexcept = default;
+            LeafStorage(const LeafStorage &) = delete;
+            LeafStorage(LeafStorage &&) = delete;
+            ~LeafStorage() noexcept;
+
+            SPR_ALWAYS_INLINE auto get(size_t idx) const noexcept -> CellRef {
+                if (m_pending) [[unlikely]] {
+                    if (auto * pending = findPending(idx))
+                        return pending->cell.ref();
+                }
+                if (m_dense)
+                    return m_dense[idx];
+                auto it = lowerBound(idx);
+                return (it != m_sparse.end() && it->index == idx) ? it->cell : nullptr;
+            }
+
+            ///Returns the first non-null cell at or after idx and before end, updating idx to its index
+            SPR_ALWAYS_INLINE auto findNext(size_t & idx, size_t end) const noexcept -> CellRef {
+                if (m_dense) {
+                    for ( ; idx < end; ++idx) {
+                        if (auto cell = m_dense[idx])
+                            return cell;
+                    }
+                    return nullptr;
+                }
+                for (auto it = lowerBound(idx); it != m_sparse.end() && it->index < end; ++it) {
+                    if (it->cell) {
+                        idx = it->index;
+                        return it->cell;
+                    }
+                }
+                idx = end;
+                return nullptr;
+            }
+
+            /*
+             Ops can modify the grid, and so this storage, re-entrantly (e.g. replacing a formula clears its 
+             extension cells). Dense slots never move but sparse entries do. Thus for sparse storage the op 
+             works on a pending slot outside of the vector which any nested access to the same index also uses.
+             */
+            template<class Op>
+            SPR_ALWAYS_INLINE auto actOn(size_t idx, Op && op) -> int {
+                if (m_pending) [[unlikely]] {
+                    if (auto * pending = findPending(idx))
+                        return std::forward<Op>(op)(pending->cell);
+                }
+                if (m_dense)
+                    return std::forward<Op>(op)(reinterpret_cast<CellPtr &>(m_dense[idx]));
+
+                PendingSlot pending{uint32_t(idx), nullptr, m_pending};
+                auto it = lowerBound(idx);
+                bool existed = (it != m_sparse.end() && it->index == idx);
+                if (existed) {
+                    //leave the entry in place to avoid shifting the vector twice
+                    pending.cell.reset(it->cell);
+                    it->cell = nullptr;
+                }
+                m_pending = &pending;
+                int nonNullDelta;
+                try {
+                    nonNullDelta = std::forward<Op>(op)(pending.cell);
+                } catch(...) {
+                    m_pending = pending.next;
+                    store(pending, existed);
+                    throw;
+                }
+                m_pending = pending.next;
+                store(pending, existed);
+                return nonNullDelta;
+            }
+
+            ///Prepares for adding up to count cells by going dense right away if they would not fit otherwise
+            void reserve(size_t count) {
+                if (!m_dense && m_sparse.size() + count > s_maxSparseCount)
+                    promote();
+            }
+
+            auto isDense() const noexcept -> bool
+                { return bool(m_dense); }
+
+            auto memoryUsage() const noexcept -> size_t {
+                return m_sparse.capacity() * sizeof(SparseEntry) + (m_dense ? s_cellCount * sizeof(CellRef) : 0);
+            }
+
+        private:
+            struct SparseEntry {
+                uint32_t index;
+                CellRef cell;
+            };
+            using SparseIterator = std::vector<SparseEntry>::iterator;
+            using SparseConstIterator = std::vector<SparseEntry>::const_iterator;
+
+            SPR_ALWAYS_INLINE auto lowerBound(size_t idx) noexcept -> SparseIterator {
+                return std::lower_bound(m_sparse.begin(), m_sparse.end(), idx, [](const SparseEntry & entry, size_t val) {
+                    return entry.index < val;
+                });
+            }
+            SPR_ALWAYS_INLINE auto lowerBound(size_t idx) const noexcept -> SparseConstIterator {
+                return std::lower_bound(m_sparse.begin(), m_sparse.end(), idx, [](const SparseEntry & entry, size_t val) {
+                    return entry.index < val;
+                });
+            }
+
+            struct PendingSlot {
+                uint32_t index;
+                CellPtr cell;
+                PendingSlot * next;
+            };
+
+            auto findPending(size_t idx) const noexcept -> PendingSlot * {
+                for (auto * pending = m_pending; pending; pending = pending->next) {
+                    if (pending->index == idx)
+                        return pending;
+                }
+                return nullptr;
+            }
+
+            ///Puts the pending slot content back into the storage
+            void store(PendingSlot & pending, bool hasEntry);
+
+            void promote();
+
+        private:
+            std::vector<SparseEntry> m_sparse;
+            std::unique_ptr<CellRef[]> m_dense;
+            PendingSlot * m_pending = nullptr;
+        };
+
         template<int Level> 
         class Tile {
         private:
             using Traits = LayerTraits<Level>;
-            using ValuePtr = std::conditional_t<Level == s_maxLevel, Cell *, Tile<Level + 1> *>;
+            using ValuePtr = std::conditional_t<Level == s_maxLevel, CellRef, Tile<Level + 1> *>;
 
             inline static constexpr size_t s_cellCount = (size_t(1) << (Traits::sizePowers.width + Traits::sizePowers.height));
         public:
@@ -108,17 +261,15 @@ namespace Spreader {
             Tile(const Tile & ) = delete;
             Tile(Tile && ) = delete;
             ~Tile() noexcept {
-                if (m_nonNullCount) {
-                    for(auto p: m_data) {
-                        if constexpr (Level != s_maxLevel)
+                if constexpr (Level != s_maxLevel) {
+                    if (m_nonNullCount) {
+                        for(auto p: m_data)
                             delete p;
-                        else
-                            reinterpret_cast<CellPtr *>(&p)->reset();
                     }
                 }
             }
 
-            SPR_ALWAYS_INLINE auto get(Point coord) const noexcept -> Cell * {
+            SPR_ALWAYS_INLINE auto get(Point coord) const noexcept -> CellRef {
 
                 if constexpr (Level != s_maxLevel) {
                     Point tileCoord = coord >> Traits::tileCoveragePowers; //e.g. remaining / tileCoverage
@@ -128,8 +279,37 @@ namespace Spreader {
                     coord &= Traits::remainderMasks; //e.g. coord %= tileCoverage
                     return next->get(coord);
                 } else {
-                    auto & cell = m_data[(coord.y << Traits::sizePowers.width) + coord.x];
-                    return cell;
+                    return m_data.get((coord.y << Traits::sizePowers.width) + coord.x);
+                }
+            }
+
+            ///Leaf only: finds the first non-null cell in the row of coord from coord.x up to endX and moves coord to it
+            SPR_ALWAYS_INLINE auto findInRow(Point & coord, SizeType endX) const noexcept -> CellRef requires(Level == s_maxLevel) {
+                
+                const size_t rowStart = size_t(coord.y) << Traits::sizePowers.width;
+                size_t idx = rowStart + coord.x;
+                auto ret = m_data.findNext(idx, rowStart + endX);
+                coord.x = SizeType(idx - rowStart);
+                return ret;
+            }
+
+            /**
+             Returns the leaf tile containing coord. If there is none returns nullptr and sets emptyExtent to
+             the size of the empty area from coord to the end of the missing tile.
+             */
+            SPR_ALWAYS_INLINE auto findLeaf(Point coord, Size & emptyExtent) const noexcept -> const Tile<s_maxLevel> * {
+
+                if constexpr (Level != s_maxLevel) {
+                    Point tileCoord = coord >> Traits::tileCoveragePowers; //e.g. remaining / tileCoverage
+                    auto & next = m_data[(tileCoord.y << Traits::sizePowers.width) + tileCoord.x];
+                    coord &= Traits::remainderMasks; //e.g. coord %= tileCoverage
+                    if (!next) {
+                        emptyExtent = (Size{1, 1} << Traits::tileCoveragePowers) - asSize(coord);
+                        return nullptr;
+                    }
+                    return next->findLeaf(coord, emptyExtent);
+                } else {
+                    return this;
                 }
             }
 
@@ -150,8 +330,7 @@ namespace Spreader {
                     addNonEmptyCount(nonNullDelta);
                     return nonNullDelta;
                 } else {
-                    auto & cell = m_data[(coord.y << Traits::sizePowers.width) + coord.x];
-                    int nonNullDelta = std::forward<Op>(op)(reinterpret_cast<CellPtr &>(cell));
+                    int nonNullDelta = m_data.actOn((coord.y << Traits::sizePowers.width) + coord.x, std::forward<Op>(op));
                     addNonEmptyCount(nonNullDelta);
                     return nonNullDelta;
                 }
@@ -187,10 +366,22 @@ namespace Spreader {
                     };
                     Point pt, ptEnd = coord + consumed;
                     int64_t nonNullDelta = 0;
-                    for (pt.y = coord.y; pt.y != ptEnd.y; ++pt.y) {
-                        for (pt.x = coord.x; pt.x != ptEnd.x; ++pt.x) {
-                            auto & cell = m_data[(pt.y << Traits::sizePowers.width) + pt.x];
-                            nonNullDelta += std::forward<Op>(op)(reinterpret_cast<CellPtr &>(cell));
+                    if constexpr (std::is_invocable_r_v<int, Op, CellPtr &, Size>) {
+                        if (std::forward<Op>(op).modifiesMissing())
+                            m_data.reserve(size_t(consumed.width) * consumed.height);
+                        for (pt.y = coord.y; pt.y != ptEnd.y; ++pt.y) {
+                            for (pt.x = coord.x; pt.x != ptEnd.x; ++pt.x) {
+                                const Size offset{pt.x - coord.x, pt.y - coord.y};
+                                nonNullDelta += m_data.actOn((pt.y << Traits::sizePowers.width) + pt.x, [&](CellPtr & cell) {
+                                    return std::forward<Op>(op)(cell, offset);
+                                });
+                            }
+                        }
+                    } else {
+                        for (pt.y = coord.y; pt.y != ptEnd.y; ++pt.y) {
+                            for (pt.x = coord.x; pt.x != ptEnd.x; ++pt.x) {
+                                nonNullDelta += m_data.actOn((pt.y << Traits::sizePowers.width) + pt.x, std::forward<Op>(op));
+                            }
                         }
                     }
                     size = consumed;
@@ -249,10 +440,13 @@ namespace Spreader {
                     endModifications(nextTo);
                     
                 } else {
-                    auto & cellFrom = m_data[(from.y << Traits::sizePowers.width) + from.x];
-                    auto & cellTo = m_data[(to.y << Traits::sizePowers.width) + to.x];
-                    nonNullDelta = std::forward<Transformer>(transformer).get(reinterpret_cast<CellPtr &>(cellFrom));
-                    nonNullDelta += std::forward<Transformer>(transformer).set(reinterpret_cast<CellPtr &>(cellTo));
+                    //the source is fully processed before the destination which is what the transformers expect anyway
+                    nonNullDelta = m_data.actOn((from.y << Traits::sizePowers.width) + from.x, [&](CellPtr & cell) {
+                        return std::forward<Transformer>(transformer).get(cell);
+                    });
+                    nonNullDelta += m_data.actOn((to.y << Traits::sizePowers.width) + to.x, [&](CellPtr & cell) {
+                        return std::forward<Transformer>(transformer).set(cell);
+                    });
                 }
                 addNonEmptyCount(nonNullDelta);
                 return nonNullDelta;
@@ -280,6 +474,19 @@ namespace Spreader {
                 return m_nonNullCount;
             }
 
+            auto memoryUsage() const noexcept -> size_t {
+                size_t ret = sizeof(*this);
+                if constexpr (Level != s_maxLevel) {
+                    for (auto p: m_data) {
+                        if (p)
+                            ret += p->memoryUsage();
+                    }
+                } else {
+                    ret += m_data.memoryUsage();
+                }
+                return ret;
+            }
+
         private:
             SPR_ALWAYS_INLINE void addNonEmptyCount(int64_t val) noexcept {
                 SPR_ASSERT_LOGIC((val >= 0 && uint64_t(val) <= s_maxCellCount - m_nonNullCount) || (val < 0 && uint64_t(-val) <= m_nonNullCount));
@@ -287,7 +494,7 @@ namespace Spreader {
             } 
         private:
             uint64_t m_nonNullCount = 0;
-            std::array<ValuePtr, s_cellCount> m_data{};
+            std::conditional_t<Level == s_maxLevel, LeafStorage, std::array<ValuePtr, s_cellCount>> m_data{};
         };
         
     public:
@@ -304,7 +511,7 @@ namespace Spreader {
          * Preconditions:
          * - coord must be within size()
          */
-        auto getCell(Point coord) const noexcept -> Cell *;
+        auto getCell(Point coord) const noexcept -> CellRef;
 
         /**
          * Modifies cell at a given coordinate.
@@ -316,9 +523,32 @@ namespace Spreader {
         template<class Op>
         void modifyCell(Point coord, Op && op);
 
+        /**
+         * Modifies all cells in rect.
+         * The op is applied to cells one leaf tile chunk at a time rather than descending the tile tree for 
+         * each cell. If it is invocable as op(CellPtr &, Point) it is also given the coordinate of each cell. 
+         * Such ops are meant for filling so leaf tiles about to receive many cells become dense up front.
+         * If rect is outside size() grid size is extended to include it.
+         */
         template<class Op>
         void modifyCells(Rect rect, Op && op);
 
+        /**
+         * Calls func(Point, CellRef) for every non-null cell in rect in row-major order.
+         * The tile tree is descended once per leaf tile in each band of rows rather than once per cell and
+         * missing tiles are skipped entirely, so sparse areas cost in proportion to the tiles that exist.
+         * If func returns bool, iteration stops as soon as it returns false and so does this function.
+         */
+        template<class Func>
+        requires(std::is_invocable_r_v<void, Func, Point, CellRef> || std::is_invocable_r_v<bool, Func, Point, CellRef>)
+        auto forEachCell(Rect rect, Func && func) const -> bool;
+
+        /**
+         * Generator version of forEachCell().
+         * The grid must not be modified while the generator is in use.
+         */
+        auto cells(Rect rect) const -> CoroGenerator<std::pair<Point, CellRef>>;
+
         template<class Transformer>
         void transformCells(Rect src, Point dest, Transformer && transformer);
 
@@ -343,6 +573,11 @@ namespace Spreader {
         auto nonNullCellCount() const noexcept -> uint64_t {
             return m_topTile ? m_topTile->nonNullCellCount() : 0;
         }
+
+        ///Approximate number of bytes used by the grid structure itself, excluding the cells
+        auto memoryUsage() const noexcept -> size_t {
+            return sizeof(*this) + (m_topTile ? m_topTile->memoryUsage() : 0);
+        }
         
         void expandWidthToAtLeast(SizeType width) {
             if (width > m_size.width)
@@ -359,10 +594,64 @@ namespace Spreader {
             expandHeightToAtLeast(size.height);
         }
 
+    private:
+        using LeafTile = Tile<s_maxLevel>;
+
+        struct LeafChunk {
+            SizeType x;
+            const LeafTile * leaf;
+        };
+
+        ///Leaf tiles crossing a band of rows. Small rectangles never need to allocate.
+        class BandLeaves {
+        public:
+            void clear() noexcept {
+                m_count = 0;
+                m_heap.clear();
+            }
+            void add(LeafChunk chunk) {
+                if (m_count < std::size(m_inline)) {
+                    m_inline[m_count] = chunk;
+                } else {
+                    if (m_heap.empty())
+                        m_heap.assign(m_inline, m_inline + m_count);
+                    m_heap.push_back(chunk);
+                }
+                ++m_count;
+            }
+            auto empty() const noexcept -> bool
+                { return m_count == 0; }
+            auto begin() const noexcept -> const LeafChunk *
+                { return m_heap.empty() ? m_inline : m_heap.data(); }
+            auto end() const noexcept -> const LeafChunk *
+                { return begin() + m_count; }
+        private:
+            LeafChunk m_inline[8];
+            std::vector<LeafChunk> m_heap;
+            size_t m_count = 0;
+        };
+
+        auto clampToSize(Rect rect) const noexcept -> Rect {
+            if (rect.origin.x >= m_size.width || rect.origin.y >= m_size.height)
+                return Rect{rect.origin, Size{0, 0}};
+            return Rect{rect.origin, Size{
+                std::min(rect.size.width, m_size.width - rect.origin.x),
+                std::min(rect.size.height, m_size.height - rect.origin.y)
+            }};
+        }
+
+        /**
+         * Fills leaves with the leaf tiles crossing rect in the band of rows that starts at y and returns the 
+         * band end. If there are none, the returned end also skips the following rows known to be empty.
+         */
+        auto findBandLeaves(Rect rect, SizeType y, BandLeaves & leaves) const -> SizeType;
+
     private:
         std::unique_ptr<Tile<0>> m_topTile = nullptr;
         Size m_size = {0, 0};
 
+        inline static constexpr Size s_leafMask = (Size{1, 1} << s_sizePowers[s_maxLevel]) - Size{1, 1};
+
     };
 
     template<class Op>
@@ -390,8 +679,10 @@ namespace Spreader {
         SPR_ASSERT_INPUT(rect.size.width <= s_maxSize.width && rect.size.height <= s_maxSize.height);
         SPR_ASSERT_INPUT(rect.origin.x <= s_maxSize.width - rect.size.width && rect.origin.y <= s_maxSize.height - rect.size.height);
 
-        if (rect.size == Size{0, 0}) [[unlikely]]
+        if (rect.size.width == 0 || rect.size.height == 0) [[unlikely]]
             return;
+
+        expandToAtLeast(asSize(rect.end()));
         
         if (!m_topTile) [[unlikely]] {
             if (!std::forward<Op>(op).modifiesMissing())
@@ -405,7 +696,11 @@ namespace Spreader {
             consumed.height = ptEnd.y - pt.y;
             for(pt.x = rect.origin.x; pt.x < ptEnd.x; pt.x += consumed.width) {
                 consumed.width = ptEnd.x - pt.x;
-                m_topTile->actOnChunk(pt, consumed, std::forward<Op>(op));
+                if constexpr (std::is_invocable_r_v<int, Op, CellPtr &, Point>) {
+                    m_topTile->actOnChunk(pt, consumed, PositionedOp<Op>{std::forward<Op>(op), pt});
+                } else {
+                    m_topTile->actOnChunk(pt, consumed, std::forward<Op>(op));
+                }
             }
         }
         
@@ -416,6 +711,42 @@ namespace Spreader {
     }
 
 
+    template<class Func>
+    requires(std::is_invocable_r_v<void, Func, Point, CellRef> || std::is_invocable_r_v<bool, Func, Point, CellRef>)
+    auto CellGrid::forEachCell(Rect rect, Func && func) const -> bool {
+
+        if (!m_topTile)
+            return true;
+
+        rect = clampToSize(rect);
+        const Point end = rect.end();
+        BandLeaves leaves;
+        for (SizeType y = rect.origin.y; y < end.y; ) {
+
+            const SizeType bandEnd = findBandLeaves(rect, y, leaves);
+            if (leaves.empty()) {
+                y = bandEnd;
+                continue;
+            }
+            for ( ; y < bandEnd; ++y) {
+                for (auto [chunkX, leaf]: leaves) {
+                    const SizeType base = chunkX & ~s_leafMask.width;
+                    const SizeType chunkEnd = std::min(end.x, (chunkX | s_leafMask.width) + 1);
+                    Point local{chunkX - base, y & s_leafMask.height};
+                    for ( ; auto cell = leaf->findInRow(local, chunkEnd - base); ++local.x) {
+                        if constexpr (std::is_invocable_r_v<bool, Func, Point, CellRef>) {
+                            if (!func(Point{base + local.x, y}, cell))
+                                return false;
+                        } else {
+                            func(Point{base + local.x, y}, cell);
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
     template<class Transformer>
     void CellGrid::transformCells(Rect src, Point dest, Transformer && transformer) {
         SPR_ASSERT_INPUT(src.origin.x < s_maxSize.width && src.origin.y < s_maxSize.height);
@@ -9,6 +9,8 @@
 #include <spreader/formula.h>
 
 #include <memory>
+#include <optional>
+#include <utility>
 
 namespace Spreader {
 
@@ -65,8 +67,188 @@ namespace Spreader {
         Scalar m_value;
     };
 
-    using CellPtr = std::unique_ptr<Cell, Cell::Deleter>;
-    static_assert(sizeof(CellPtr) == sizeof(Cell *), "your standard library has defective unique_ptr that is not pointer sized with 0-size deleter");
+    /**
+     Non-owning view of a grid slot.
+
+     A slot holds either nothing, a pointer to a Cell or, for numbers, booleans, errors and blanks, the 
+     value itself. Such values do not need a heap allocated ValueCell and are read without a pointer chase.
+
+     Numbers are stored as their bit pattern with the exponent bits flipped. Since numbers are always finite
+     the resulting exponent is never 0. Words with 0 exponent are pointers if the sign bit is clear 
+     and other inline values if it is set. This requires untagged cell pointers that fit in 52 bits which 
+     is checked on every construction.
+     */
+    class CellRef {
+    friend class CellPtr;
+    public:
+        constexpr CellRef() noexcept = default;
+        constexpr CellRef(std::nullptr_t) noexcept {}
+        CellRef(const Cell * cell) noexcept : m_word(uint64_t(reinterpret_cast<uintptr_t>(cell))) {
+            //Tagged pointers (e.g. ARM TBI/MTE) or addresses above 2^52 would be mistaken for inline values
+            if (m_word > s_pointerMask) [[unlikely]]
+                SPR_FATAL_ERROR("cell pointer does not fit in 52 bits");
+        }
+
+        ///Returns the inline representation of the value if it has one
+        static auto inlineFor(const Scalar & value) noexcept -> std::optional<CellRef> {
+            return applyVisitor([](const auto & val) -> std::optional<CellRef> {
+                using T = std::remove_cvref_t<decltype(val)>;
+
+                if constexpr (std::is_same_v<T, Number>) {
+                    return CellRef(SPR_BIT_CAST(uint64_t, val.value()) ^ Numeric::nonFiniteMask);
+                } else if constexpr (std::is_same_v<T, bool>) {
+                    return CellRef(s_specialTag | s_boolKind | uint64_t(val));
+                } else if constexpr (std::is_same_v<T, Error>) {
+                    return CellRef(s_specialTag | s_errorKind | uint64_t(val));
+                } else if constexpr (std::is_same_v<T, Scalar::Blank>) {
+                    return CellRef(s_specialTag | s_blankKind);
+                } else {
+                    return std::nullopt;
+                }
+            }, value);
+        }
+
+        explicit operator bool() const noexcept
+            { return m_word != 0; }
+
+        auto isInline() const noexcept -> bool 
+            { return m_word > s_pointerMask; }
+
+        auto isInlineNumber() const noexcept -> bool
+            { return m_word & Numeric::nonFiniteMask; }
+
+        auto inlineNumber() const noexcept -> double {
+            SPR_ASSERT_LOGIC(isInlineNumber());
+            return SPR_BIT_CAST(double, m_word ^ Numeric::nonFiniteMask);
+        }
+
+        ///The cell pointed to or nullptr if the value is inline
+        auto get() const noexcept -> Cell * 
+            { return isInline() ? nullptr : reinterpret_cast<Cell *>(uintptr_t(m_word)); }
+
+        auto getType() const noexcept -> CellType
+            { return isInline() ? CellType::Value : get()->getType(); }
+
+        auto value() const noexcept -> Scalar {
+            if (isInline())
+                return inlineValue();
+            return get()->value();
+        }
+
+        ///Calls func with the value without copying the one stored in a cell
+        template<class Func>
+        SPR_ALWAYS_INLINE decltype(auto) withValue(Func && func) const {
+            if (isInline()) {
+                const Scalar value = inlineValue();
+                return std::forward<Func>(func)(value);
+            }
+            return std::forward<Func>(func)(get()->value());
+        }
+
+        friend auto operator==(CellRef lhs, CellRef rhs) noexcept -> bool = default;
+        friend auto operator!=(CellRef lhs, CellRef rhs) noexcept -> bool = default;
+
+    private:
+        constexpr explicit CellRef(uint64_t word) noexcept : m_word(word)
+        {}
+
+        auto inlineValue() const noexcept -> Scalar {
+            SPR_ASSERT_LOGIC(isInline());
+            if (isInlineNumber())
+                return inlineNumber();
+            switch (m_word & s_kindMask) {
+                case s_boolKind:  return bool(m_word & s_payloadMask);
+                case s_errorKind: return Error(m_word & s_payloadMask);
+                default:          return Scalar::Blank{};
+            }
+        }
+
+    private:
+        static constexpr uint64_t s_pointerMask = (uint64_t(1) << 52) - 1;
+        static constexpr uint64_t s_specialTag = uint64_t(1) << 63;
+        static constexpr uint64_t s_kindMask = 0xFF00;
+        static constexpr uint64_t s_blankKind = 0x0100;
+        static constexpr uint64_t s_boolKind = 0x0200;
+        static constexpr uint64_t s_errorKind = 0x0300;
+        static constexpr uint64_t s_payloadMask = 0xFF;
+
+        uint64_t m_word = 0;
+
+        static_assert(sizeof(uintptr_t) <= sizeof(uint64_t), "pointers must fit in the inline word");
+    };
+
+    /**
+     Owning grid slot. See CellRef for what it can hold.
+     */
+    class CellPtr {
+    public:
+        constexpr CellPtr() noexcept = default;
+        constexpr CellPtr(std::nullptr_t) noexcept {}
+        template<class T>
+        requires(std::is_base_of_v<Cell, T>)
+        CellPtr(std::unique_ptr<T, Cell::Deleter> && ptr) noexcept : m_ref(ptr.release())
+        {}
+        explicit CellPtr(Cell * ptr) noexcept : m_ref(ptr)
+        {}
+        CellPtr(CellPtr && src) noexcept : m_ref(src.release())
+        {}
+        ~CellPtr() noexcept
+            { reset(); }
+
+        ///Creates an inline value if possible and a ValueCell otherwise
+        static auto fromValue(const Scalar & value) -> CellPtr;
+
+        ///Takes ownership of what ref refers to
+        static auto adopt(CellRef ref) noexcept -> CellPtr {
+            CellPtr ret;
+            ret.m_ref = ref;
+            return ret;
+        }
+
+        auto operator=(CellPtr && src) noexcept -> CellPtr & {
+            reset(src.release());
+            return *this;
+        }
+        auto operator=(std::nullptr_t) noexcept -> CellPtr & {
+            reset();
+            return *this;
+        }
+        template<class T>
+        requires(std::is_base_of_v<Cell, T>)
+        auto operator=(std::unique_ptr<T, Cell::Deleter> && ptr) noexcept -> CellPtr & {
+            reset(CellRef(ptr.release()));
+            return *this;
+        }
+
+        explicit operator bool() const noexcept
+            { return bool(m_ref); }
+        auto isInline() const noexcept -> bool 
+            { return m_ref.isInline(); }
+        auto ref() const noexcept -> CellRef
+            { return m_ref; }
+        ///The cell owned or nullptr if the value is inline
+        auto get() const noexcept -> Cell *
+            { return m_ref.get(); }
+        auto operator->() const noexcept -> Cell * {
+            SPR_ASSERT_LOGIC(!isInline());
+            return get();
+        }
+        auto getType() const noexcept -> CellType
+            { return m_ref.getType(); }
+        auto value() const noexcept -> Scalar
+            { return m_ref.value(); }
+
+        auto release() noexcept -> CellRef 
+            { return std::exchange(m_ref, nullptr); }
+        void reset(CellRef ref = nullptr) noexcept {
+            auto old = std::exchange(m_ref, ref);
+            if (auto * cell = old.get())
+                Cell::Deleter()(cell);
+        }
+    private:
+        CellRef m_ref;
+    };
+    static_assert(sizeof(CellPtr) == sizeof(CellRef));
 
     using ValueCellPtr = std::unique_ptr<ValueCell, Cell::Deleter>;
     using FormulaCellPtr = std::unique_ptr<FormulaCell, Cell::Deleter>;
@@ -135,6 +317,10 @@ namespace Spreader {
             { return m_extent; }
         void setExtent(Size val) noexcept 
             { m_extent = val; }
+        auto order() const noexcept -> uint64_t
+            { return m_order; }
+        void setOrder(uint64_t val) noexcept
+            { m_order = val; }
         
         void replaceFormula(ConstFormulaPtr && formula, ConstFormulaReferencesPtr && refs) {
             m_formula = std::move(formula);
@@ -149,13 +335,22 @@ namespace Spreader {
 
         auto needsRecalc(bool generation) const noexcept -> bool 
             { return m_generation != generation; }
+        void setNeedsRecalc(bool generation) noexcept
+            { m_generation = !generation; }
         auto setBeingCalculated(bool val) noexcept
-            { m_inProgress = val; }
-        auto isCircularDependency() const noexcept -> bool
-            { return m_inProgress || m_blocked; }
+            { m_inProgress = val; m_inputsChanged = false; }
+        auto isBeingCalculated() const noexcept -> bool
+            { return m_inProgress; }
+        auto inputsChanged() const noexcept -> bool
+            { return m_inputsChanged; }
+        void setInputsChanged() noexcept
+            { m_inputsChanged = true; }
+        auto isCircularDependency(bool generation) const noexcept -> bool
+            { return m_inProgress || (m_blocked && m_generation == generation); }
         auto finishCalculation(bool generation, bool blocked) noexcept {
             m_generation = generation;
             m_inProgress = false;
+            m_inputsChanged = false;
             m_blocked = blocked;
         }
 
@@ -188,6 +383,8 @@ namespace Spreader {
         Size m_extent = {1, 1};
         FormulaCell * m_prevFormulaCell = nullptr;
         FormulaCell * m_nextFormulaCell = nullptr;
+        ///Position of the cell in sheet's recalculation order
+        uint64_t m_order = 0;
         ///Boolean. If unequal to sheet recalc generation means that cell is stale
         uint8_t m_generation:1 = 0;  
         ///Boolean. If true signifies that the cell is being calculated. When observed during calc of another 
@@ -195,6 +392,8 @@ namespace Spreader {
         uint8_t m_inProgress:1 = 0;  
         ///Boolean. Signifies that last evaluation of the cell resulted in circular dependency. 
         uint8_t m_blocked:1 = 0;
+        ///Boolean. Signifies that cells already read by a paused calculation might have changed. 
+        uint8_t m_inputsChanged:1 = 0;
     };
 
     class FormulaCellExtension final : public Cell {
@@ -231,13 +430,47 @@ namespace Spreader {
         FormulaCell * m_parentFormulaCell;
     };
 
+    /**
+     What applyToCell() passes for values stored inline in a slot. 
+     
+     Handlers treat it as a ValueCell that cannot be modified in place.
+     */
+    class InlineValueCell {
+    public:
+        InlineValueCell(CellRef ref) noexcept : m_ref(ref)
+        {}
+        InlineValueCell(const CellPtr & ptr) noexcept : m_ref(ptr.ref())
+        {}
+
+        auto value() const noexcept -> Scalar
+            { return m_ref.value(); }
+
+        auto isBlank() const noexcept -> bool
+            { return value().isBlank(); }
+
+        auto copy() const noexcept -> CellPtr
+            { return CellPtr::adopt(m_ref); }
+    private:
+        CellRef m_ref;
+    };
+
+    inline auto CellPtr::fromValue(const Scalar & value) -> CellPtr {
+        if (auto ref = CellRef::inlineFor(value))
+            return adopt(*ref);
+        return ValueCell::create(value);
+    }
+
     template<class T, class CellPtrLike>
     SPR_ALWAYS_INLINE auto downcastCell(CellPtrLike && cell) {
 
-        if constexpr (std::is_const_v<std::remove_pointer_t<decltype(&*cell)>>)
-            return static_cast<const T *>(&*cell);
-        else
-            return static_cast<T *>(&*cell);
+        if constexpr (std::is_pointer_v<std::remove_cvref_t<CellPtrLike>>) {
+            if constexpr (std::is_const_v<std::remove_pointer_t<std::remove_cvref_t<CellPtrLike>>>)
+                return static_cast<const T *>(cell);
+            else
+                return static_cast<T *>(cell);
+        } else {
+            return static_cast<T *>(cell.get());
+        }
     }
 
     template<class CellPtrLike, class Func>
@@ -245,8 +478,14 @@ namespace Spreader {
         if (!cell)
             return func(nullptr);
 
+        if constexpr (!std::is_pointer_v<std::remove_cvref_t<CellPtrLike>>) {
+            if (cell.isInline()) {
+                InlineValueCell inlineCell(cell);
+                return func(&inlineCell);
+            }
+        }
         
-        switch(cell->getType()) {
+        switch(downcastCell<Cell>(cell)->getType()) {
             case CellType::Value: return func(downcastCell<ValueCell>(std::forward<CellPtrLike>(cell)));
             case CellType::Formula: return func(downcastCell<FormulaCell>(std::forward<CellPtrLike>(cell)));
             case CellType::FormulaExtension: return func(downcastCell<FormulaCellExtension>(std::forward<CellPtrLike>(cell)));
@@ -264,7 +503,7 @@ namespace Spreader {
         });
     }
 
-    inline auto getRecalcDependency(const Cell * cell, bool generation) noexcept -> FormulaCell * {
+    inline auto getRecalcDependency(CellRef cell, bool generation) noexcept -> FormulaCell * {
         return applyToCell(cell, [generation](auto ptr) -> FormulaCell * {
             using T = std::remove_cv_t<std::remove_pointer_t<decltype(ptr)>>;
 
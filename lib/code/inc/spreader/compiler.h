@@ -69,5 +69,15 @@
 
 #endif
 
+#if defined(__AVX__)
+	#define SPR_HAS_AVX 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SPR_HAS_SSE2 1
+#endif
+#if (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+	#define SPR_HAS_NEON_FP64 1
+#endif
+
 
 #endif
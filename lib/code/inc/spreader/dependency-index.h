@@ -0,0 +1,171 @@
+// Copyright (c) 2022, Eugene Gershnik
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef SPR_HEADER_DEPENDENCY_INDEX_H_INCLUDED
+#define SPR_HEADER_DEPENDENCY_INDEX_H_INCLUDED
+
+#include <spreader/cell.h>
+#include <spreader/formula.h>
+#include <spreader/rtree.h>
+
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Spreader {
+
+    /**
+     Reverse mapping from cells to formulas that reference them.
+
+     Given a rectangle of cells that changed, the index enumerates all formulas that may observe the change.
+     Single cell references are kept in a hash map while ranges are kept in an R-tree so that neither
+     huge ranges nor a large number of them requires a linear scan.
+     It is conservative: a formula may be reported more than once and may be reported even though its result
+     is not affected.
+
+     Formulas are registered with the references and location they have at the time of registration.
+     Whenever either of these changes the formula must be re-registered via add().
+
+     Formulas filled over an area share the same references which point to the same relative
+     places from each cell. These are registered together as a group: the precedents of every
+     reference over the whole area are stored once and the dependents of a change are computed from
+     them, so the index does not grow with the size of the area. A group member is located by its
+     position so it must be removed (or re-added) before it is moved.
+     */
+    class DependencyIndex {
+    private:
+        struct PointHash {
+            auto operator()(Point pt) const noexcept -> size_t {
+                return std::hash<uint64_t>()((uint64_t(pt.x) << 32) | pt.y);
+            }
+        };
+
+        struct Registration {
+            ConstFormulaReferencesPtr references;
+            Point location;
+        };
+
+        struct Precedent {
+            Rect rect;
+            bool dependsOnSize;
+        };
+
+        struct Group {
+            ConstFormulaReferencesPtr references;
+            Rect area;
+            ///Row-major, null for cells no longer in the group
+            std::vector<FormulaCell *> members;
+            size_t count;
+            bool dependsOnSize = false;
+
+            auto indexOf(Point pt) const noexcept -> size_t {
+                return size_t(pt.y - area.origin.y) * area.size.width + (pt.x - area.origin.x);
+            }
+        };
+
+        struct GroupReference {
+            Group * group;
+            size_t index;
+
+            friend auto operator==(const GroupReference &, const GroupReference &) noexcept -> bool = default;
+        };
+
+    public:
+        ///Registers (or re-registers) references of a formula cell
+        void add(FormulaCell * cell);
+        ///Unregisters a formula cell. It is fine to call it for an unregistered one.
+        void remove(FormulaCell * cell);
+        void clear() noexcept;
+
+        /**
+         Registers formula cells filled over an area.
+         
+         The cells must all have the same references that are dereferencable at every point of the area.
+         They are given in row-major order of their locations.
+         */
+        void addGroup(Rect area, std::vector<FormulaCell *> && cells);
+
+        ///Marks or unmarks the formula cell as needing recalculation regardless of its precedents
+        void setVolatile(FormulaCell * cell, bool value);
+
+        template<class Func>
+        void forEachDependent(Rect rect, Func && func) const {
+
+            if (uint64_t(rect.size.width) * rect.size.height <= m_cellDependents.size()) {
+                Point pt;
+                for (pt.y = rect.origin.y; pt.y < rect.origin.y + rect.size.height; ++pt.y) {
+                    for (pt.x = rect.origin.x; pt.x < rect.origin.x + rect.size.width; ++pt.x) {
+                        auto [first, last] = m_cellDependents.equal_range(pt);
+                        for ( ; first != last; ++first)
+                            func(first->second);
+                    }
+                }
+            } else {
+                for (auto & [pt, cell]: m_cellDependents) {
+                    if (contains(rect, pt))
+                        func(cell);
+                }
+            }
+
+            m_areaPrecedents.forEachIntersecting(rect, [&](Rect, FormulaCell * cell) {
+                func(cell);
+            });
+
+            m_groupPrecedents.forEachIntersecting(rect, [&](Rect, const GroupReference & ref) {
+                auto dependents = dependentArea(*ref.group, ref.index, rect);
+                Point pt;
+                for (pt.y = dependents.origin.y; pt.y < dependents.origin.y + dependents.size.height; ++pt.y) {
+                    for (pt.x = dependents.origin.x; pt.x < dependents.origin.x + dependents.size.width; ++pt.x) {
+                        if (auto cell = ref.group->members[ref.group->indexOf(pt)])
+                            func(cell);
+                    }
+                }
+            });
+        }
+
+        template<class Func>
+        void forEachVolatile(Func && func) const {
+            for (auto cell: m_volatiles)
+                func(cell);
+        }
+
+        ///Formulas that reference whole rows or columns and so depend on the size of the grid
+        template<class Func>
+        void forEachSizeDependent(Func && func) const {
+            for (auto cell: m_sizeDependents)
+                func(cell);
+            for (auto & group: m_groups) {
+                if (!group.dependsOnSize)
+                    continue;
+                for (auto cell: group.members) {
+                    if (cell)
+                        func(cell);
+                }
+            }
+        }
+
+    private:
+        static auto precedentOf(const FormulaReferences::Entry & ref, Point location) noexcept -> std::optional<Precedent>;
+        template<class Func>
+        static void forEachPrecedent(const Registration & reg, Func && func);
+        ///Bounds of the precedents of the reference with the given index over the whole group area
+        static auto groupPrecedentOf(const Group & group, size_t refIndex) noexcept -> std::optional<Precedent>;
+        ///Part of the group area whose reference with the given index points into the rect
+        static auto dependentArea(const Group & group, size_t refIndex, Rect rect) noexcept -> Rect;
+
+        void removeFromGroup(FormulaCell * cell);
+
+    private:
+        std::unordered_map<FormulaCell *, Registration> m_registrations;
+        std::unordered_multimap<Point, FormulaCell *, PointHash> m_cellDependents;
+        RTree<FormulaCell *> m_areaPrecedents;
+        std::unordered_set<FormulaCell *> m_sizeDependents;
+        std::unordered_set<FormulaCell *> m_volatiles;
+        std::list<Group> m_groups;
+        RTree<Group *> m_groupAreas;
+        RTree<GroupReference> m_groupPrecedents;
+    };
+}
+
+#endif
@@ -0,0 +1,44 @@
+// Copyright (c) 2022, Eugene Gershnik
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef SPR_HEADER_FORMULA_CACHE_H_INCLUDED
+#define SPR_HEADER_FORMULA_CACHE_H_INCLUDED
+
+#include <spreader/formula.h>
+
+#include <unordered_map>
+
+namespace Spreader {
+
+    /**
+     Shares parsed formulas between cells whose formula text differs only by location.
+
+     A formula typed into many cells with relative references (A1*2 in B1, A2*2 in B2...) has the 
+     same position-independent key everywhere and is parsed only once. The formula and its 
+     references are immutable so they are shared as is.
+     */
+    class FormulaCache {
+    public:
+        struct Statistics {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+        };
+
+    public:
+        auto parse(const String & str, Point at) -> std::pair<ConstFormulaPtr, ConstFormulaReferencesPtr>;
+
+        auto statistics() const noexcept -> const Statistics &
+            { return m_statistics; }
+
+        void clear() noexcept
+            { m_entries.clear(); }
+
+    private:
+        std::unordered_map<std::string, std::pair<ConstFormulaPtr, ConstFormulaReferencesPtr>> m_entries;
+        Statistics m_statistics;
+
+        static constexpr size_t s_maxEntries = 4096;
+    };
+}
+
+#endif
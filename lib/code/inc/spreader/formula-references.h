@@ -72,6 +72,8 @@ namespace Spreader {
         auto operator[](size_t idx) noexcept -> Entry & { return entries()[idx]; }
 
 
+        ///Whether copies to every point of the area can keep these references unchanged
+        auto isCopyableTo(Rect dest) const noexcept -> bool;
         auto adjustToCopy(Point dest) const -> refcnt_ptr<const FormulaReferences>;
         auto adjustToMove(Point from, Point to) const -> refcnt_ptr<const FormulaReferences>;
         auto adjustToRowDeletion(SizeType at, SizeType y, SizeType count) const -> refcnt_ptr<const FormulaReferences>;
@@ -6,6 +6,10 @@
 
 #include <spreader/types.h>
 #include <spreader/ast-node.h>
+#include <spreader/bytecode.h>
+
+#include <optional>
+#include <string>
 
 namespace Spreader {
 
@@ -17,16 +21,35 @@ namespace Spreader {
     public:
         static auto parse(String str, Point at) -> std::pair<refcnt_ptr<Formula>, FormulaReferencesPtr>;
 
+        /**
+         Returns a key for the formula text that does not depend on where it is parsed.
+
+         Relative references are keyed by their distance from the location and so texts with equal
+         keys parse into the same formula and references. Returns nullopt if the text cannot be tokenized.
+         */
+        static auto positionIndependentKey(const String & str, Point at) -> std::optional<std::string>;
+
         auto reconstructAt(const ConstFormulaReferencesPtr & refs, Point pt) const -> String;
+        
+        auto isVolatile() const noexcept -> bool
+            { return m_isVolatile; }
+        auto hasSyntaxError() const noexcept -> bool
+            { return dynamic_cast<const ParseErrorNode *>(TraversalAccessBase::firstChild(this)) != nullptr; }
 
     private:
-        Formula(AstNodePtr && root):
-            FunctionNode(ArgumentList(std::move(root))) {
+        Formula(AstNodePtr && root, bool isVolatile, const FormulaReferences * refs):
+            FunctionNode(ArgumentList(std::move(root))),
+            m_isVolatile(isVolatile),
+            m_bytecode(Bytecode::compile(*TraversalAccessBase::firstChild(this), refs)) {
         }
 
         auto execute(ExecutionContext & context) const -> bool override;
         void reconstructAfterChild(const ReconstructionContext & context, uint16_t idx, StringBuilder & dest) const override;
-
+        
+    private:
+        bool m_isVolatile;
+        ///Compiled form of simple formulas. Empty if the AST needs to be used.
+        Bytecode m_bytecode;
     };
     using FormulaPtr = refcnt_ptr<Formula>;
     using ConstFormulaPtr = refcnt_ptr<const Formula>;
@@ -6,6 +6,8 @@
 
 #include <spreader/types.h>
 
+#include <algorithm>
+
 #include <stdint.h>
 
 #if SPR_TESTING
@@ -122,6 +124,29 @@ namespace Spreader {
         }
     };
 
+    constexpr inline auto contains(Rect rect, Point pt) noexcept -> bool {
+        return pt.x >= rect.origin.x && pt.x - rect.origin.x < rect.size.width &&
+               pt.y >= rect.origin.y && pt.y - rect.origin.y < rect.size.height;
+    }
+
+    constexpr inline auto contains(Rect outer, Rect inner) noexcept -> bool {
+        return inner.origin.x >= outer.origin.x && inner.origin.y >= outer.origin.y &&
+               inner.origin.x - outer.origin.x + inner.size.width <= outer.size.width &&
+               inner.origin.y - outer.origin.y + inner.size.height <= outer.size.height;
+    }
+
+    constexpr inline auto boundingRect(Rect lhs, Rect rhs) noexcept -> Rect {
+        Point origin{std::min(lhs.origin.x, rhs.origin.x), std::min(lhs.origin.y, rhs.origin.y)};
+        Point end{std::max(lhs.origin.x + lhs.size.width, rhs.origin.x + rhs.size.width),
+                  std::max(lhs.origin.y + lhs.size.height, rhs.origin.y + rhs.size.height)};
+        return Rect{origin, Size{end.x - origin.x, end.y - origin.y}};
+    }
+
+    constexpr inline auto intersects(Rect lhs, Rect rhs) noexcept -> bool {
+        return lhs.origin.x < rhs.origin.x + rhs.size.width && rhs.origin.x < lhs.origin.x + lhs.size.width &&
+               lhs.origin.y < rhs.origin.y + rhs.size.height && rhs.origin.y < lhs.origin.y + lhs.size.height;
+    }
+
     #if SPR_TESTING
 
         inline auto operator<<(std::ostream & str, Size size) -> std::ostream & {
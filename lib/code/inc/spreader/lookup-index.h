@@ -0,0 +1,187 @@
+// Copyright (c) 2022, Eugene Gershnik
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef SPR_HEADER_LOOKUP_INDEX_H_INCLUDED
+#define SPR_HEADER_LOOKUP_INDEX_H_INCLUDED
+
+#include <spreader/scalar.h>
+#include <spreader/rtree.h>
+#include <spreader/string-pool.h>
+
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace Spreader {
+
+    /**
+     Positions of the first occurrence of each value in a row or column of cells.
+
+     It answers exact lookups (as done by VLOOKUP, HLOOKUP and MATCH) without scanning the cells.
+     The matching rules are the ones of the scan: numbers, booleans and strings match equal values,
+     blanks match 0 and errors never match. Strings containing wildcard characters cannot be looked up.
+     */
+    class LookupIndex final : public ref_counted<LookupIndex, REFCNT_FLAGS> {
+        friend ref_counted;
+    public:
+        static auto create() -> refcnt_ptr<LookupIndex>
+            { return refcnt_attach(new LookupIndex); }
+
+        static auto canFind(const Scalar & value) noexcept -> bool;
+
+        void add(SizeType idx, const Scalar & value);
+
+        ///Returns the position of the first matching value or std::nullopt if there is none
+        auto find(const Scalar & value) const noexcept -> std::optional<SizeType>;
+
+    private:
+        LookupIndex() = default;
+        ~LookupIndex() noexcept = default;
+
+    private:
+        std::unordered_map<double, SizeType> m_numbers;
+        std::unordered_map<String, SizeType, std::hash<String>, StringEqual> m_strings;
+        std::optional<SizeType> m_firstTrue;
+        std::optional<SizeType> m_firstFalse;
+        std::optional<SizeType> m_firstBlank;
+    };
+
+    using ConstLookupIndexPtr = refcnt_ptr<const LookupIndex>;
+
+    /**
+     Values of a row or column of cells that approximate lookups compare against, in order of position.
+
+     Approximate lookups bisect the cells and values they cannot compare with the looked up one (e.g. blanks
+     for strings) are stepped over one by one. When the comparable values are sorted the result is fully 
+     determined by them so it can be found by a binary search here instead. Numbers are compared with numbers
+     and blanks (as 0), strings with strings and booleans with booleans. Only the ends of each run of blanks 
+     are stored since no other blank can be the result.
+     */
+    class SortedLookupIndex final : public ref_counted<SortedLookupIndex, REFCNT_FLAGS> {
+        friend ref_counted;
+    private:
+        template<class T>
+        struct Sequence {
+            std::vector<SizeType> positions;
+            std::vector<T> values;
+            bool ascending = true;
+            bool descending = true;
+
+            void add(SizeType idx, const T & value);
+            auto findNotGreater(const T & value) const noexcept -> std::optional<SizeType>;
+            auto findNotLess(const T & value) const noexcept -> std::optional<SizeType>;
+        };
+    public:
+        static auto create() -> refcnt_ptr<SortedLookupIndex>
+            { return refcnt_attach(new SortedLookupIndex); }
+
+        static auto canFind(const Scalar & value) noexcept -> bool;
+
+        void add(SizeType idx, const Scalar & value);
+        ///Adds a run of blanks (missing cells) at [first, last]
+        void addBlanks(SizeType first, SizeType last);
+
+        ///Whether the values comparable with the given one are sorted in the specified order
+        auto isSorted(const Scalar & value, bool descending) const noexcept -> bool;
+
+        ///Position of the last value not greater than the given one. The comparable values must be ascending.
+        auto findNotGreater(const Scalar & value) const noexcept -> std::optional<SizeType>;
+        /**
+         Position of the first value equal to the given one or, if there is none, of the last one greater 
+         than it. The comparable values must be descending.
+         */
+        auto findNotLess(const Scalar & value) const noexcept -> std::optional<SizeType>;
+
+    private:
+        SortedLookupIndex() = default;
+        ~SortedLookupIndex() noexcept = default;
+
+        template<class Func>
+        auto visitSequence(const Scalar & value, Func && func) const noexcept;
+
+    private:
+        Sequence<double> m_numbers;
+        Sequence<String> m_strings;
+        Sequence<bool> m_booleans;
+    };
+
+    using ConstSortedLookupIndexPtr = refcnt_ptr<const SortedLookupIndex>;
+
+    /**
+     Lookup indices shared by all formulas that look up in the same area.
+
+     Each area has at most one index of each kind (LookupIndex and SortedLookupIndex).
+
+     An index is only built the second time an area is looked up in. Ranges that move from formula to
+     formula (e.g. A1:A100, A2:A101...) are looked up only once each and building an index for those would
+     cost a full scan where the plain lookup can stop at the first match.
+
+     Indices are discarded when anything in their area changes. Lookups may be done concurrently but
+     not at the same time as invalidation.
+     */
+    class LookupIndexCache {
+    private:
+        struct Entry {
+            Rect area;
+            ConstLookupIndexPtr index;
+            ConstSortedLookupIndexPtr sortedIndex;
+        };
+    public:
+        /**
+         Returns the index for the area building it via build(LookupIndex &) -> bool if needed.
+
+         Returns nullptr if the index is not worth building yet or build() failed. The returned index
+         stays valid even if it is discarded from the cache.
+         */
+        template<class Index, class Builder>
+        requires(std::is_same_v<Index, LookupIndex> || std::is_same_v<Index, SortedLookupIndex>)
+        auto get(Rect area, Builder && build) -> refcnt_ptr<const Index> {
+
+        #if !SPR_SINGLE_THREADED
+            auto lock = std::lock_guard(m_mutex);
+        #endif
+            Entry * entry = nullptr;
+            m_areas.forEachIntersecting(area, [&](Rect rect, Entry * candidate) {
+                if (rect == area)
+                    entry = candidate;
+            });
+            if (!entry) {
+                add(area);
+                return nullptr;
+            }
+            auto & index = [entry]() -> refcnt_ptr<const Index> & {
+                if constexpr (std::is_same_v<Index, LookupIndex>)
+                    return entry->index;
+                else
+                    return entry->sortedIndex;
+            }();
+            if (!index) {
+                auto newIndex = Index::create();
+                if (!build(*newIndex))
+                    return nullptr;
+                index = std::move(newIndex);
+            }
+            return index;
+        }
+
+        void invalidate(Rect area);
+        void clear() noexcept;
+
+    private:
+        void add(Rect area);
+
+    private:
+        ///In order of creation
+        std::list<Entry> m_entries;
+        RTree<Entry *> m_areas;
+    #if !SPR_SINGLE_THREADED
+        std::mutex m_mutex;
+    #endif
+
+        static constexpr size_t s_maxEntries = 256;
+    };
+}
+
+#endif
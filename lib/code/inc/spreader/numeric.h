@@ -10,9 +10,16 @@
 #include <cstring>
 #include <concepts>
 #include <limits>
+#include <type_traits>
 
 #include <stdint.h>
 
+#if SPR_HAS_AVX || SPR_HAS_SSE2
+    #include <immintrin.h>
+#elif SPR_HAS_NEON_FP64
+    #include <arm_neon.h>
+#endif
+
 namespace Spreader::Numeric {
 
     constexpr uint64_t divByZeroPattern = 0xFFF8000000000001;
@@ -87,6 +94,12 @@ namespace Spreader::Numeric {
             m_ccs = m_ccs + cc;
         }
 
+        //Each step depends on the previous one so a block is summed in order to give identical results
+        constexpr void add(const T * values, size_t count) noexcept {
+            for (size_t i = 0; i < count; ++i)
+                add(values[i]);
+        }
+
         constexpr auto value() const noexcept -> T {
             return m_sum + m_cs + m_ccs;
         }
@@ -105,6 +118,11 @@ namespace Spreader::Numeric {
             m_current.add(increment);
         }
 
+        constexpr void add(const T * values, size_t count) noexcept {
+            for (size_t i = 0; i < count; ++i)
+                add(values[i]);
+        }
+
         constexpr auto value() const noexcept -> T {
             return m_current.value();
         }
@@ -126,6 +144,11 @@ namespace Spreader::Numeric {
             m_currentDenomTimesSigmaSquared.add(incrementOfDenomTimesSigmaSquared);
         }
 
+        constexpr void add(const T * values, size_t count) noexcept {
+            for (size_t i = 0; i < count; ++i)
+                add(values[i]);
+        }
+
         constexpr auto value() const noexcept -> T {
             SPR_ASSERT_LOGIC(m_count > 0);
             T denom;
@@ -145,6 +168,71 @@ namespace Spreader::Numeric {
         T m_count = 0;
     };
     
+    /**
+     Maximum or minimum of init and a block of finite values, vectorized when possible.
+
+     The result is identical to comparing the values one by one in order keeping the first one on ties.
+     Vector max/min instructions keep the earlier value on ties too but lanes see different subsequences 
+     so +0 and -0 could be picked in a different order. Such a result is recomputed one value at a time.
+     */
+    template<bool IsMax>
+    inline auto extremum(const double * values, size_t count, double init) noexcept -> double {
+        
+        auto better = [](double val, double current) {
+            if constexpr (IsMax)
+                return val > current;
+            else
+                return val < current;
+        };
+
+        double ret = init;
+        size_t i = 0;
+    #if SPR_HAS_AVX
+        if (count >= 8) {
+            __m256d acc = _mm256_set1_pd(init);
+            for ( ; i + 4 <= count; i += 4) {
+                __m256d val = _mm256_loadu_pd(values + i);
+                acc = IsMax ? _mm256_max_pd(val, acc) : _mm256_min_pd(val, acc);
+            }
+            alignas(32) double lanes[4];
+            _mm256_store_pd(lanes, acc);
+            for (double lane: lanes)
+                ret = better(lane, ret) ? lane : ret;
+        }
+    #elif SPR_HAS_SSE2
+        if (count >= 4) {
+            __m128d acc = _mm_set1_pd(init);
+            for ( ; i + 2 <= count; i += 2) {
+                __m128d val = _mm_loadu_pd(values + i);
+                acc = IsMax ? _mm_max_pd(val, acc) : _mm_min_pd(val, acc);
+            }
+            alignas(16) double lanes[2];
+            _mm_store_pd(lanes, acc);
+            for (double lane: lanes)
+                ret = better(lane, ret) ? lane : ret;
+        }
+    #elif SPR_HAS_NEON_FP64
+        if (count >= 4) {
+            float64x2_t acc = vdupq_n_f64(init);
+            for ( ; i + 2 <= count; i += 2) {
+                float64x2_t val = vld1q_f64(values + i);
+                acc = IsMax ? vmaxq_f64(val, acc) : vminq_f64(val, acc);
+            }
+            for (double lane: {vgetq_lane_f64(acc, 0), vgetq_lane_f64(acc, 1)})
+                ret = better(lane, ret) ? lane : ret;
+        }
+    #endif
+        for ( ; i < count; ++i)
+            ret = better(values[i], ret) ? values[i] : ret;
+
+        if (ret == 0) {
+            ret = init;
+            for (i = 0; i < count; ++i)
+                ret = better(values[i], ret) ? values[i] : ret;
+        }
+        return ret;
+    }
+
     template<std::totally_ordered T>
     requires(std::is_same_v<decltype(std::numeric_limits<T>::min()), T>)
     class Max {
@@ -153,6 +241,16 @@ namespace Spreader::Numeric {
             if (val > m_value)
                 m_value = val;
         }
+        constexpr void add(const T * values, size_t count) noexcept {
+            if constexpr (std::is_same_v<T, double>) {
+                if (!std::is_constant_evaluated()) {
+                    m_value = extremum</*IsMax*/true>(values, count, m_value);
+                    return;
+                }
+            }
+            for (size_t i = 0; i < count; ++i)
+                add(values[i]);
+        }
         constexpr auto value() const noexcept -> T {
             return m_value;
         }
@@ -168,6 +266,16 @@ namespace Spreader::Numeric {
             if (val < m_value)
                 m_value = val;
         }
+        constexpr void add(const T * values, size_t count) noexcept {
+            if constexpr (std::is_same_v<T, double>) {
+                if (!std::is_constant_evaluated()) {
+                    m_value = extremum</*IsMax*/false>(values, count, m_value);
+                    return;
+                }
+            }
+            for (size_t i = 0; i < count; ++i)
+                add(values[i]);
+        }
         constexpr auto value() const noexcept -> T {
             return m_value;
         }
@@ -0,0 +1,297 @@
+// Copyright (c) 2022, Eugene Gershnik
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef SPR_HEADER_RTREE_H_INCLUDED
+#define SPR_HEADER_RTREE_H_INCLUDED
+
+#include <spreader/geometry.h>
+#include <spreader/error-handling.h>
+
+#include <concepts>
+#include <memory>
+#include <vector>
+
+namespace Spreader {
+
+    /**
+     Spatial multimap from rectangles to values.
+
+     This is a classical R-tree (Guttman, quadratic split). Each node holds up to MaxEntries
+     rectangles with either child nodes or values. Finding all rectangles intersecting a given
+     one only descends into nodes whose bounds intersect it, which is logarithmic in the number of
+     stored rectangles for the kind of data we have: many small or overlapping ranges.
+
+     The same rectangle may be stored multiple times with different (or even same) values.
+     */
+    template<std::equality_comparable T>
+    class RTree {
+    private:
+        static constexpr size_t MaxEntries = 16;
+        static constexpr size_t MinEntries = MaxEntries * 2 / 5;
+
+        struct Node {
+            explicit Node(bool isLeaf_): isLeaf(isLeaf_)
+            {}
+
+            auto count() const noexcept -> size_t
+                { return bounds.size(); }
+
+            auto totalBounds() const noexcept -> Rect {
+                SPR_ASSERT_LOGIC(!bounds.empty());
+                Rect ret = bounds[0];
+                for (size_t i = 1; i < bounds.size(); ++i)
+                    ret = boundingRect(ret, bounds[i]);
+                return ret;
+            }
+
+            bool isLeaf;
+            std::vector<Rect> bounds;
+            std::vector<std::unique_ptr<Node>> children;
+            std::vector<T> values;
+        };
+
+    public:
+        RTree() = default;
+        RTree(RTree &&) noexcept = default;
+        RTree & operator=(RTree &&) noexcept = default;
+
+        auto size() const noexcept -> size_t
+            { return m_size; }
+        auto empty() const noexcept -> bool
+            { return m_size == 0; }
+
+        void insert(Rect rect, T value) {
+            if (!m_root)
+                m_root = std::make_unique<Node>(true);
+            if (auto sibling = insert(*m_root, rect, std::move(value))) {
+                auto newRoot = std::make_unique<Node>(false);
+                newRoot->bounds.push_back(m_root->totalBounds());
+                newRoot->children.push_back(std::move(m_root));
+                newRoot->bounds.push_back(sibling->totalBounds());
+                newRoot->children.push_back(std::move(sibling));
+                m_root = std::move(newRoot);
+            }
+            ++m_size;
+        }
+
+        ///Removes one occurrence of a rectangle with the given value. Returns whether it was found.
+        auto erase(Rect rect, const T & value) -> bool {
+            if (!m_root)
+                return false;
+
+            std::vector<std::pair<Rect, T>> orphans;
+            if (!erase(*m_root, rect, value, orphans))
+                return false;
+            --m_size;
+
+            while (!m_root->isLeaf && m_root->count() == 1)
+                m_root = std::move(m_root->children[0]);
+            if (m_root->count() == 0)
+                m_root.reset();
+
+            m_size -= orphans.size();
+            for (auto & [orphanRect, orphanValue]: orphans)
+                insert(orphanRect, std::move(orphanValue));
+            return true;
+        }
+
+        void clear() noexcept {
+            m_root.reset();
+            m_size = 0;
+        }
+
+        ///Invokes func(Rect, const T &) for every stored rectangle that intersects the given one
+        template<class Func>
+        void forEachIntersecting(Rect rect, Func && func) const {
+            if (m_root)
+                forEachIntersecting(*m_root, rect, func);
+        }
+
+    private:
+        template<class Func>
+        static void forEachIntersecting(const Node & node, Rect rect, Func & func) {
+            for (size_t i = 0; i < node.count(); ++i) {
+                if (!intersects(node.bounds[i], rect))
+                    continue;
+                if (node.isLeaf)
+                    func(node.bounds[i], node.values[i]);
+                else
+                    forEachIntersecting(*node.children[i], rect, func);
+            }
+        }
+
+        static auto area(Rect rect) noexcept -> double
+            { return double(rect.size.width) * double(rect.size.height); }
+
+        static auto enlargement(Rect bounds, Rect rect) noexcept -> double
+            { return area(boundingRect(bounds, rect)) - area(bounds); }
+
+        //Returns the new sibling if the node had to be split
+        static auto insert(Node & node, Rect rect, T && value) -> std::unique_ptr<Node> {
+
+            if (node.isLeaf) {
+                node.bounds.push_back(rect);
+                node.values.push_back(std::move(value));
+            } else {
+                size_t best = 0;
+                double bestEnlargement = enlargement(node.bounds[0], rect);
+                for (size_t i = 1; i < node.count(); ++i) {
+                    auto current = enlargement(node.bounds[i], rect);
+                    if (current < bestEnlargement ||
+                        (current == bestEnlargement && area(node.bounds[i]) < area(node.bounds[best]))) {
+                        best = i;
+                        bestEnlargement = current;
+                    }
+                }
+                auto & child = *node.children[best];
+                auto sibling = insert(child, rect, std::move(value));
+                node.bounds[best] = child.totalBounds();
+                if (sibling) {
+                    node.bounds.push_back(sibling->totalBounds());
+                    node.children.push_back(std::move(sibling));
+                }
+            }
+
+            if (node.count() > MaxEntries)
+                return split(node);
+            return nullptr;
+        }
+
+        static auto erase(Node & node, Rect rect, const T & value, std::vector<std::pair<Rect, T>> & orphans) -> bool {
+
+            if (node.isLeaf) {
+                for (size_t i = 0; i < node.count(); ++i) {
+                    if (node.bounds[i] == rect && node.values[i] == value) {
+                        node.bounds.erase(node.bounds.begin() + i);
+                        node.values.erase(node.values.begin() + i);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            for (size_t i = 0; i < node.count(); ++i) {
+                if (!contains(node.bounds[i], rect))
+                    continue;
+                auto & child = *node.children[i];
+                if (!erase(child, rect, value, orphans))
+                    continue;
+                if (child.count() < MinEntries) {
+                    collectValues(child, orphans);
+                    node.bounds.erase(node.bounds.begin() + i);
+                    node.children.erase(node.children.begin() + i);
+                } else {
+                    node.bounds[i] = child.totalBounds();
+                }
+                return true;
+            }
+            return false;
+        }
+
+        static void collectValues(Node & node, std::vector<std::pair<Rect, T>> & dest) {
+            for (size_t i = 0; i < node.count(); ++i) {
+                if (node.isLeaf)
+                    dest.emplace_back(node.bounds[i], std::move(node.values[i]));
+                else
+                    collectValues(*node.children[i], dest);
+            }
+        }
+
+        static auto split(Node & node) -> std::unique_ptr<Node> {
+
+            auto count = node.count();
+
+            //Pick the pair that would waste the most area if put together
+            size_t seed1 = 0, seed2 = 1;
+            double worstWaste = -1;
+            for (size_t i = 0; i < count; ++i) {
+                for (size_t j = i + 1; j < count; ++j) {
+                    auto waste = area(boundingRect(node.bounds[i], node.bounds[j])) - area(node.bounds[i]) - area(node.bounds[j]);
+                    if (waste > worstWaste) {
+                        worstWaste = waste;
+                        seed1 = i;
+                        seed2 = j;
+                    }
+                }
+            }
+
+            //0 - unassigned, 1 - stays, 2 - moves to the new node
+            std::vector<uint8_t> groups(count, 0);
+            groups[seed1] = 1;
+            groups[seed2] = 2;
+            Rect bounds[2] = {node.bounds[seed1], node.bounds[seed2]};
+            size_t counts[2] = {1, 1};
+
+            for (size_t remaining = count - 2; remaining > 0; --remaining) {
+
+                uint8_t forcedGroup = 0;
+                if (counts[0] + remaining == MinEntries)
+                    forcedGroup = 1;
+                else if (counts[1] + remaining == MinEntries)
+                    forcedGroup = 2;
+
+                //Pick the entry with the strongest preference for one group
+                size_t next = count;
+                double bestDifference = -1;
+                double nextEnlargements[2] = {};
+                for (size_t i = 0; i < count; ++i) {
+                    if (groups[i] != 0)
+                        continue;
+                    double enlargements[2] = {enlargement(bounds[0], node.bounds[i]), enlargement(bounds[1], node.bounds[i])};
+                    auto difference = enlargements[0] > enlargements[1] ? enlargements[0] - enlargements[1] : enlargements[1] - enlargements[0];
+                    if (difference > bestDifference) {
+                        bestDifference = difference;
+                        next = i;
+                        nextEnlargements[0] = enlargements[0];
+                        nextEnlargements[1] = enlargements[1];
+                    }
+                }
+                SPR_ASSERT_LOGIC(next < count);
+
+                uint8_t group = forcedGroup;
+                if (!group) {
+                    if (nextEnlargements[0] != nextEnlargements[1])
+                        group = nextEnlargements[0] < nextEnlargements[1] ? 1 : 2;
+                    else if (area(bounds[0]) != area(bounds[1]))
+                        group = area(bounds[0]) < area(bounds[1]) ? 1 : 2;
+                    else
+                        group = counts[0] <= counts[1] ? 1 : 2;
+                }
+                groups[next] = group;
+                bounds[group - 1] = boundingRect(bounds[group - 1], node.bounds[next]);
+                ++counts[group - 1];
+            }
+
+            auto sibling = std::make_unique<Node>(node.isLeaf);
+            size_t kept = 0;
+            for (size_t i = 0; i < count; ++i) {
+                if (groups[i] == 2) {
+                    sibling->bounds.push_back(node.bounds[i]);
+                    if (node.isLeaf)
+                        sibling->values.push_back(std::move(node.values[i]));
+                    else
+                        sibling->children.push_back(std::move(node.children[i]));
+                } else {
+                    node.bounds[kept] = node.bounds[i];
+                    if (node.isLeaf)
+                        node.values[kept] = std::move(node.values[i]);
+                    else
+                        node.children[kept] = std::move(node.children[i]);
+                    ++kept;
+                }
+            }
+            node.bounds.resize(kept);
+            if (node.isLeaf)
+                node.values.erase(node.values.begin() + kept, node.values.end());
+            else
+                node.children.resize(kept);
+            return sibling;
+        }
+
+    private:
+        std::unique_ptr<Node> m_root;
+        size_t m_size = 0;
+    };
+}
+
+#endif
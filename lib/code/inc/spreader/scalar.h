@@ -11,7 +11,10 @@
 #include <spreader/typelist.h>
 #include <spreader/floating-decimal.h>
 #include <spreader/compiler.h>
+#include <spreader/util.h>
 
+#include <cstring>
+#include <memory>
 #include <variant>
 
 #if SPR_TESTING
@@ -20,6 +23,13 @@
 
 namespace Spreader {
 
+    /**
+     A single value of any type a cell or an expression can have.
+
+     The value is stored in a union tagged with its type rather than in std::variant. Everything but strings
+     is a trivially copyable 8 byte payload so copying such a Scalar is a plain memory copy and visiting
+     one or two Scalars is a switch on the tag(s).
+     */
     class Scalar {
     public:
         using Blank = std::monostate;
@@ -33,98 +43,271 @@ namespace Spreader {
         >;
 
     private:
-        using ImplType = Types::WrapIn<std::variant>;
+        enum class Kind : uint8_t {
+            Blank,
+            Bool,
+            Number,
+            String,
+            Error
+        };
+
+        template<class T>
+        static constexpr Kind kindOf = [] {
+            if constexpr (std::is_same_v<T, Blank>)
+                return Kind::Blank;
+            else if constexpr (std::is_same_v<T, bool>)
+                return Kind::Bool;
+            else if constexpr (std::is_same_v<T, Number>)
+                return Kind::Number;
+            else if constexpr (std::is_same_v<T, String>)
+                return Kind::String;
+            else if constexpr (std::is_same_v<T, Error>)
+                return Kind::Error;
+            else
+                static_assert(dependentFalse<T>, "not a Scalar type");
+        }();
+
+        template<class T>
+        static constexpr bool IsStringConvertible = !Types::contains<std::remove_cvref_t<T>> && 
+                                                    !std::is_same_v<std::remove_cvref_t<T>, Scalar> &&
+                                                    !std::is_arithmetic_v<std::remove_cvref_t<T>> &&
+                                                    std::is_constructible_v<String, T &&>;
+
+        static_assert(std::is_trivially_copyable_v<Number> && sizeof(bool) <= sizeof(Number) && sizeof(Error) <= sizeof(Number),
+                      "all non-string payloads must be copyable as a Number");
+
+        template<class T, class... Args>
+        constexpr void construct(Args && ...args) {
+            if constexpr (std::is_same_v<T, String>)
+                new (&m_string) String(std::forward<Args>(args)...);
+            else
+                std::construct_at(&alternative<T>(), std::forward<Args>(args)...);
+        }
+
+        constexpr void destroy() noexcept {
+            if (m_kind == Kind::String)
+                m_string.~String();
+        }
+
+        constexpr void copyPayload(const Scalar & src) noexcept {
+            if (std::is_constant_evaluated()) {
+                switch(src.m_kind) {
+                    case Kind::Blank:   std::construct_at(&m_blank); break;
+                    case Kind::Bool:    std::construct_at(&m_bool, src.m_bool); break;
+                    case Kind::Number:  std::construct_at(&m_number, src.m_number); break;
+                    case Kind::Error:   std::construct_at(&m_error, src.m_error); break;
+                    case Kind::String:  SPR_FATAL_ERROR("string is not a trivial payload");
+                }
+            } else {
+                std::memcpy(static_cast<void *>(&m_number), &src.m_number, sizeof(Number));
+            }
+        }
+
+        template<class T>
+        constexpr auto alternative() noexcept -> T & {
+            if constexpr (std::is_same_v<T, Blank>)
+                return m_blank;
+            else if constexpr (std::is_same_v<T, bool>)
+                return m_bool;
+            else if constexpr (std::is_same_v<T, Number>)
+                return m_number;
+            else if constexpr (std::is_same_v<T, String>)
+                return m_string;
+            else if constexpr (std::is_same_v<T, Error>)
+                return m_error;
+            else
+                static_assert(dependentFalse<T>, "not a Scalar type");
+        }
+
+        template<class T>
+        constexpr auto alternative() const noexcept -> const T & {
+            return const_cast<Scalar *>(this)->alternative<T>();
+        }
+
+        ///The alternative with the value category of the Scalar
+        template<class T, class S>
+        static constexpr auto forwardAlternative(S && scalar) noexcept -> decltype(auto) {
+            if constexpr (std::is_lvalue_reference_v<S>)
+                return scalar.template alternative<T>();
+            else
+                return std::move(scalar.template alternative<T>());
+        }
+
+        template<class Visitor>
+        SPR_ALWAYS_INLINE static auto visit(Visitor && visitor) -> decltype(auto) {
+            return std::forward<Visitor>(visitor)();
+        }
+
+        template<class Visitor, class First, class... Rest>
+        SPR_ALWAYS_INLINE static auto visit(Visitor && visitor, First && first, Rest && ...rest) -> decltype(auto) {
+            
+            auto next = [&](auto && val) -> decltype(auto) {
+                return visit([&](auto && ...others) -> decltype(auto) {
+                    return std::forward<Visitor>(visitor)(std::forward<decltype(val)>(val), 
+                                                          std::forward<decltype(others)>(others)...);
+                }, std::forward<Rest>(rest)...);
+            };
+            
+            switch(first.m_kind) {
+                case Kind::Blank:   return next(forwardAlternative<Blank>(std::forward<First>(first)));
+                case Kind::Bool:    return next(forwardAlternative<bool>(std::forward<First>(first)));
+                case Kind::Number:  return next(forwardAlternative<Number>(std::forward<First>(first)));
+                case Kind::String:  return next(forwardAlternative<String>(std::forward<First>(first)));
+                case Kind::Error:   break;
+            }
+            return next(forwardAlternative<Error>(std::forward<First>(first)));
+        }
 
     public:
-        constexpr Scalar() noexcept = default;
+        constexpr Scalar() noexcept : 
+            m_blank(),
+            m_kind(Kind::Blank)
+        {}
+
+        template<class T>
+        requires(Types::contains<std::remove_cvref_t<T>>)
+        constexpr Scalar(T && val) noexcept(std::is_nothrow_constructible_v<std::remove_cvref_t<T>, T &&>) : 
+            m_kind(kindOf<std::remove_cvref_t<T>>) {
+            construct<std::remove_cvref_t<T>>(std::forward<T>(val));
+        }
 
         template<class T>
-        requires(std::is_constructible_v<ImplType, T &&>)
-        constexpr Scalar(T && val) noexcept(std::is_nothrow_constructible_v<ImplType, T &&>) : 
-            m_impl(std::forward<T>(val)) 
+        requires(IsStringConvertible<T>)
+        Scalar(T && val) noexcept(std::is_nothrow_constructible_v<String, T &&>) :
+            Scalar(String(std::forward<T>(val)))
         {}
         
-        constexpr Scalar(std::integral auto val) noexcept requires(!std::is_constructible_v<ImplType, decltype(val)>) :
-            m_impl(Number(val))
+        constexpr Scalar(std::integral auto val) noexcept requires(!std::is_same_v<decltype(val), bool>) :
+            Scalar(Number(val))
         {}
         
-        constexpr Scalar(double val) noexcept {
+        constexpr Scalar(double val) noexcept : 
+            m_blank(),
+            m_kind(Kind::Blank) {
             Number::fromDouble(val, [&](auto v) {
-                m_impl.emplace<decltype(v)>(v);
+                this->assign(v);
             });
         }
 
+        constexpr Scalar(const Scalar & src) noexcept(std::is_nothrow_copy_constructible_v<String>) :
+            m_kind(src.m_kind) {
+            if (m_kind == Kind::String)
+                new (&m_string) String(src.m_string);
+            else
+                copyPayload(src);
+        }
+
+        constexpr Scalar(Scalar && src) noexcept(std::is_nothrow_move_constructible_v<String>) :
+            m_kind(src.m_kind) {
+            if (m_kind == Kind::String)
+                new (&m_string) String(std::move(src.m_string));
+            else
+                copyPayload(src);
+        }
+
+        constexpr ~Scalar() noexcept {
+            if (m_kind == Kind::String)
+                m_string.~String();
+        }
+
+        constexpr auto operator=(const Scalar & src) noexcept(std::is_nothrow_copy_constructible_v<String>) -> Scalar & {
+            if (src.m_kind == Kind::String) {
+                if (m_kind == Kind::String) {
+                    m_string = src.m_string;
+                } else {
+                    new (&m_string) String(src.m_string);
+                    m_kind = Kind::String;
+                }
+            } else if (this != &src) {
+                destroy();
+                copyPayload(src);
+                m_kind = src.m_kind;
+            }
+            return *this;
+        }
+
+        constexpr auto operator=(Scalar && src) noexcept(std::is_nothrow_move_constructible_v<String>) -> Scalar & {
+            if (src.m_kind == Kind::String) {
+                if (m_kind == Kind::String) {
+                    m_string = std::move(src.m_string);
+                } else {
+                    new (&m_string) String(std::move(src.m_string));
+                    m_kind = Kind::String;
+                }
+            } else if (this != &src) {
+                destroy();
+                copyPayload(src);
+                m_kind = src.m_kind;
+            }
+            return *this;
+        }
+
         template<class T>
         requires(Types::contains<std::remove_cvref_t<T>>)
-        auto assign(T && arg) -> std::remove_cvref_t<T> & {
-            return m_impl.emplace<std::remove_cvref_t<T>>(std::forward<T>(arg));
+        constexpr auto assign(T && arg) -> std::remove_cvref_t<T> & {
+            using Type = std::remove_cvref_t<T>;
+            //arg may be (a part of) our own value
+            Type val(std::forward<T>(arg));
+            destroy();
+            construct<Type>(std::move(val));
+            m_kind = kindOf<Type>;
+            return alternative<Type>();
         }
 
-        friend void swap(Scalar & lhs, Scalar & rhs) {
-            using std::swap;
-            swap(lhs.m_impl, rhs.m_impl);
+        friend void swap(Scalar & lhs, Scalar & rhs) noexcept {
+            Scalar temp(std::move(lhs));
+            lhs = std::move(rhs);
+            rhs = std::move(temp);
         }
 
         constexpr auto isBlank() const noexcept -> bool {
-            return std::get_if<Blank>(&m_impl);
+            return m_kind == Kind::Blank;
         }
 
         template<class T>
         friend constexpr auto get(const Scalar & v) noexcept -> const T & {
-            auto p = std::get_if<T>(&v.m_impl);
-            SPR_ASSERT_INPUT(p);
-            return *p;
+            SPR_ASSERT_INPUT(v.m_kind == kindOf<T>);
+            return v.alternative<T>();
         }
         template<class T>
         friend constexpr auto get(Scalar & v) noexcept -> T & {
-            auto p = std::get_if<T>(&v.m_impl);
-            SPR_ASSERT_INPUT(p);
-            return *p;
+            SPR_ASSERT_INPUT(v.m_kind == kindOf<T>);
+            return v.alternative<T>();
         }
         template<class T>
         friend constexpr auto get(Scalar && v) noexcept -> T && {
-            auto p = std::get_if<T>(&v.m_impl);
-            SPR_ASSERT_INPUT(p);
-            return std::move(*p);
+            SPR_ASSERT_INPUT(v.m_kind == kindOf<T>);
+            return std::move(v.alternative<T>());
         }
         template<class T>
         friend constexpr auto get(const Scalar * v) noexcept -> const T * {
-            return std::get_if<T>(v ? &v->m_impl : nullptr);
+            return v && v->m_kind == kindOf<T> ? &v->alternative<T>() : nullptr;
         }
         template<class T>
         friend constexpr auto get(Scalar * v) noexcept -> T * {
-            return std::get_if<T>(v ? &v->m_impl : nullptr);
+            return v && v->m_kind == kindOf<T> ? &v->alternative<T>() : nullptr;
         }
 
         template<class Visitor, class... Scalars>
         friend auto applyVisitor(Visitor && visitor, Scalars && ...values) 
         requires(std::is_same_v<std::remove_cvref_t<Scalars>, Scalar> && ...) {
-            return std::visit(std::forward<Visitor>(visitor), std::forward<Scalars>(values).m_impl...);
+            return visit(std::forward<Visitor>(visitor), std::forward<Scalars>(values)...);
         }
 
         friend auto operator==(const Scalar & lhs, const Scalar & rhs) noexcept -> bool {
-            return applyVisitor([](auto && lhs, auto && rhs) -> bool {
-
-                using LHS = std::remove_cvref_t<decltype(lhs)>;
-                using RHS = std::remove_cvref_t<decltype(rhs)>;
-
-                if constexpr (std::is_same_v<LHS, RHS>) 
-                    return lhs == rhs;
-                else
-                    return false;
-            }, lhs, rhs);
+            if (lhs.m_kind != rhs.m_kind)
+                return false;
+            switch(lhs.m_kind) {
+                case Kind::Blank:   return true;
+                case Kind::Bool:    return lhs.m_bool == rhs.m_bool;
+                case Kind::Number:  return lhs.m_number == rhs.m_number;
+                case Kind::String:  return lhs.m_string == rhs.m_string;
+                case Kind::Error:   return lhs.m_error == rhs.m_error;
+            }
+            SPR_FATAL_ERROR("invalid Scalar kind");
         }
         friend auto operator!=(const Scalar & lhs, const Scalar & rhs) noexcept -> bool {
-            return applyVisitor([](auto && lhs, auto && rhs) -> bool {
-
-                using LHS = std::remove_cvref_t<decltype(lhs)>;
-                using RHS = std::remove_cvref_t<decltype(rhs)>;
-
-                if constexpr (std::is_same_v<LHS, RHS>) 
-                    return lhs != rhs;
-                else
-                    return true;
-            }, lhs, rhs);
+            return !(lhs == rhs);
         }
 
 
@@ -181,7 +364,14 @@ namespace Spreader {
         }
         
     private:
-        ImplType m_impl;
+        union {
+            Blank m_blank;
+            bool m_bool;
+            Number m_number;
+            String m_string;
+            Error m_error;
+        };
+        Kind m_kind;
     };
 
 #if SPR_TESTING
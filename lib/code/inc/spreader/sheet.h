@@ -5,11 +5,21 @@
 #define SPR_HEADER_SHEET_H_INCLUDED
 
 #include <spreader/cell-grid.h>
+#include <spreader/dependency-index.h>
+#include <spreader/formula-cache.h>
 #include <spreader/linked-list.h>
+#include <spreader/lookup-index.h>
 #include <spreader/interval-map.h>
 #include <spreader/name-manager.h>
+#include <spreader/string-pool.h>
 #include <spreader/coro-generator.h>
 
+#include <memory>
+#include <set>
+#include <span>
+#include <unordered_set>
+#include <vector>
+
 namespace Spreader {
 
     class FormulaEvaluator;
@@ -40,7 +50,24 @@ namespace Spreader {
             { return CellGrid::maxSize(); }
         
         void setValueCell(Point coord, const Scalar & value);
+        /**
+         Sets all cells in rect from values given in row-major order.
+
+         This has the same effect as calling setValueCell() for each cell but visits the grid tiles once 
+         per area rather than once per cell and recalculates only once at the end. There must be exactly 
+         as many values as cells in rect.
+         */
+        void setValueCells(Rect rect, std::span<const Scalar> values);
+        void setValueCells(Rect rect, std::span<const double> values);
+        void setValueCells(Rect rect, std::span<const String> values);
         void setFormulaCell(Point coord, const String & formula);
+        /**
+         Fills rect with a formula as if it was set at anchor and then copied to every cell of rect.
+
+         The formula is parsed only once. Its relative references are shared by all the cells of rect 
+         rather than being adjusted for each one, unless they would become invalid in some of them.
+         */
+        void fillFormula(Rect rect, const String & formula, Point anchor);
         void clearCell(Point coord);
 
         void copyCell(Point from, Rect to);
@@ -63,14 +90,59 @@ namespace Spreader {
                 recalculate();
         }
         void recalculate();
+    #if !SPR_SINGLE_THREADED
+        ///Limits the number of threads recalculation can use. 0, the default, means one per hardware thread.
+        void setRecalcThreadCount(unsigned count) noexcept
+            { m_recalcThreadCount = count; }
+    #endif
+
+        /**
+         Makes equal strings stored in cells share storage.
+
+         When enabled string values set via setValueCell() and strings produced by formulas are taken from
+         a pool of distinct strings. This saves memory when few distinct strings repeat across many cells.
+         Strings no cell holds any longer are dropped from the pool each time it doubles in size.
+         Disabling the pooling discards the pool but cells keep sharing what they already share.
+         */
+        void setStringPooling(bool enable);
+        ///Statistics of the string pool or std::nullopt if pooling is disabled
+        auto stringPoolStatistics() const noexcept -> std::optional<StringPool::Statistics> {
+            if (!m_stringPool)
+                return std::nullopt;
+            return m_stringPool->statistics();
+        }
 
 
         auto getValue(Point coord) const -> Scalar {
-            if (auto * cell = m_grid.getCell(coord))
-                return cell->value();
+            if (auto cell = m_grid.getCell(coord))
+                return cell.value();
             return Scalar{};
         }
 
+        ///Type of each value read by getValues()
+        enum class ValueType : uint8_t {
+            Blank,
+            Bool,
+            Number,
+            String,
+            Error
+        };
+
+        /**
+         Reads all values in rect into caller provided buffers in row-major order.
+
+         For each cell types receives the type of its value and numbers receives:
+         - the value itself for numbers
+         - 1 or 0 for booleans
+         - the numeric value of Error for errors
+         - an index into strings for strings. The strings are appended to it.
+         - 0 for blanks
+
+         Both buffers must have exactly as many elements as there are cells in rect. Only the populated 
+         cells in rect are visited, the rest is filled in bulk.
+         */
+        void getValues(Rect rect, std::span<double> numbers, std::span<ValueType> types, std::vector<String> & strings) const;
+
         struct FormulaInfo {
             String text;
             Size extent;
@@ -92,10 +164,50 @@ namespace Spreader {
             });
         }
 
+        /**
+         Calls func(Point, const Scalar &, bool isFormula) for each non-blank cell in rect in row-major order.
+         
+         isFormula is true for cells that contain a formula, that is the ones getFormulaInfo() returns 
+         a value for, even if the value is blank. Cells an array formula spills into report false.
+         Only the existing cells are visited, so sparse areas are cheap to scan.
+         */
+        template<class Func>
+        requires(std::is_invocable_r_v<void, Func, Point, const Scalar &, bool> ||
+                 std::is_invocable_r_v<bool, Func, Point, const Scalar &, bool>)
+        auto forEachCell(Rect rect, Func && func) const ->
+            std::conditional_t<std::is_invocable_r_v<bool, Func, Point, const Scalar &, bool>, bool, void> {
+
+            SPR_ASSERT_INPUT(rect.origin.x < maxSize().width && rect.origin.y < maxSize().height);
+            
+            [[maybe_unused]] auto ret = m_grid.forEachCell(rect, [&](Point pt, CellRef cell) {
+                bool isFormula = cell.getType() == CellType::Formula;
+                return cell.withValue([&](const Scalar & value) {
+                    if (!isFormula && value.isBlank())
+                        return true;
+                    if constexpr (std::is_invocable_r_v<bool, Func, Point, const Scalar &, bool>) {
+                        return bool(func(pt, value, isFormula));
+                    } else {
+                        func(pt, value, isFormula);
+                        return true;
+                    }
+                });
+            });
+            if constexpr (std::is_invocable_r_v<bool, Func, Point, const Scalar &, bool>)
+                return ret;
+        }
+
+        ///Generator version of forEachCell(). The sheet must not be modified while it is in use.
+        auto cells(Rect rect) const -> CoroGenerator<std::tuple<Point, const Scalar &, bool>>;
+
         auto nonNullCellCount() const noexcept -> uint64_t {
             return m_grid.nonNullCellCount();
         }
 
+        ///Hits and misses of the cache that shares parsed formulas between cells
+        auto formulaCacheStatistics() const noexcept -> const FormulaCache::Statistics & {
+            return m_formulaCache.statistics();
+        }
+
         
         auto parseColumn(const String & str) const -> std::optional<SizeType>
             { return m_nameManager.parseColumn(str); }
@@ -153,7 +265,9 @@ namespace Spreader {
     private:
         struct SetBlankCell;
         struct SetValueCell;
+        template<class T> struct SetValueCells;
         struct SetFormulaCell;
+        struct FillFormulaCell;
         struct CopyCell;
         struct MoveCell;
         struct SimpleMoveCell;
@@ -161,13 +275,42 @@ namespace Spreader {
         struct ReplaceOldExtensionCell;
         struct ReserveNewExtensionCell;
         struct ClearExtensionCell;
+        struct PendingEvaluation;
+        struct PendingEvaluations;
+
+        struct RecalcOrder {
+            auto operator()(const FormulaCell * lhs, const FormulaCell * rhs) const noexcept -> bool
+                { return lhs->order() < rhs->order(); }
+        };
 
         auto evaluate(FormulaCell * formulaCell, FormulaEvaluator & evaluator) -> bool;
+    #if !SPR_SINGLE_THREADED
+        auto evaluateConcurrently(unsigned threadCount) -> bool;
+    #endif
+        template<class T>
+        void setValueCellsFrom(Rect rect, std::span<const T> values);
         void reserveExtent(FormulaCell * formulaCell, Size extent);
         void applyEvaluationResult(FormulaCell * formulaCell, FormulaEvaluator & evaluator);
         
         void removeFormulaDependents(FormulaCell * formulaCell);
 
+        void addFormulaCell(FormulaCell * formulaCell);
+        ///Adds the cell to the recalculation lists but does not index its dependencies
+        void enlistFormulaCell(FormulaCell * formulaCell);
+        void eraseFormulaCell(FormulaCell * formulaCell);
+        void markStale(FormulaCell * formulaCell);
+        void markAllStale();
+        void reindexFormulaCells();
+        void markChanged(Rect area);
+        void markChanged(Point pt)
+            { markChanged(Rect{pt, Size{1, 1}}); }
+        void markDependentsStale();
+        void poolString(Scalar & value) {
+            if (m_stringPool)
+                m_stringPool->intern(value);
+        }
+        void purgeStringPoolIfNeeded();
+
         void recalcIfNotSuspended() {
             if (m_recalcSuspendedCount == 0)
                 recalculate();
@@ -181,13 +324,36 @@ namespace Spreader {
     private:
         CellGrid m_grid;
         LinkedList<FormulaCell, FormulaCell::LinkedListTraits> m_formulaCells;
+        ///Formula cells that need recalculation in the order they need to be recalculated
+        std::set<FormulaCell *, RecalcOrder> m_staleFormulaCells;
+        ///Formula cells already recalculated in the current pass
+        std::unordered_set<FormulaCell *> m_recalculatedFormulaCells;
+        ///Formula cells made stale again during the current pass. These are deferred to the next one.
+        std::vector<FormulaCell *> m_deferredFormulaCells;
+        DependencyIndex m_dependencies;
+        ///Areas whose content changed since their dependents were last marked stale
+        std::vector<Rect> m_changedAreas;
+        LookupIndexCache m_lookupIndices;
+        Size m_calculatedSize;
+        uint64_t m_lastFormulaOrder = 0;
         bool m_evalGeneration = false;
         unsigned m_recalcSuspendedCount = 0;
+    #if !SPR_SINGLE_THREADED
+        unsigned m_recalcThreadCount = 0;
+    #endif
         LengthMap m_rowHeights;
         LengthMap m_columnWidths;
         NameManager m_nameManager;
+        FormulaCache m_formulaCache;
+        std::unique_ptr<StringPool> m_stringPool;
         
         static inline constexpr LengthInfo s_defaultLengthInfo{std::nullopt, false};
+        static constexpr size_t s_maxPausedEvaluators = 4096;
+        static constexpr uint64_t s_minFormulaGroupSize = 16;
+    #if !SPR_SINGLE_THREADED
+        static constexpr size_t s_minConcurrentRecalcCount = 256;
+        static constexpr size_t s_concurrentRecalcChunk = 32;
+    #endif
     };
     
 #if SPR_TESTING
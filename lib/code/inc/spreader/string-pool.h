@@ -0,0 +1,116 @@
+// Copyright (c) 2022, Eugene Gershnik
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef SPR_HEADER_STRING_POOL_H_INCLUDED
+#define SPR_HEADER_STRING_POOL_H_INCLUDED
+
+#include <spreader/scalar.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace Spreader {
+
+    /**
+     String equality that compares storage pointers before the characters.
+
+     Strings taken from a StringPool share storage when equal so comparing them usually ends at the
+     pointer check. On platforms where the string storage is not directly accessible this is the
+     same as ==.
+     */
+    struct StringEqual {
+        auto operator()(const String & lhs, const String & rhs) const noexcept -> bool {
+            return sharesStorage(lhs, rhs) || lhs == rhs;
+        }
+
+        static auto sharesStorage(const String & lhs, const String & rhs) noexcept -> bool {
+            if constexpr (CharAccessHasData<String::char_access>) {
+                String::char_access lhsAccess(lhs), rhsAccess(rhs);
+                return lhsAccess.data() == rhsAccess.data() && lhsAccess.size() == rhsAccess.size();
+            } else {
+                return false;
+            }
+        }
+
+    private:
+        template<class CharAccess>
+        static auto dummyCharAccessHasData(decltype(std::declval<CharAccess>().data())) -> std::true_type;
+        template<class CharAccess>
+        static auto dummyCharAccessHasData(...) -> std::false_type;
+
+        template<class CharAccess>
+        static constexpr bool CharAccessHasData = decltype(dummyCharAccessHasData<CharAccess>(nullptr))::value;
+    };
+
+    /**
+     A set of distinct strings that equal strings can share storage with.
+
+     Interning a string returns the pooled string equal to it, adding it to the pool if there is none.
+     Values stored through the pool therefore keep a single copy of their characters no matter how
+     many cells contain them. Strings nobody else uses any longer stay in the pool until it is purged, 
+     cleared or destroyed. Purging is worthwhile once needsPurge() returns true.
+     */
+    class StringPool {
+    public:
+        struct Statistics {
+            ///Number of distinct strings in the pool
+            size_t distinctCount = 0;
+            ///Bytes of character storage held by the pool
+            size_t storageSize = 0;
+            ///Number of interned strings that were replaced by an equal pooled one
+            size_t sharedCount = 0;
+            ///Bytes of character storage the replaced strings would have taken separately
+            size_t savedSize = 0;
+        };
+    public:
+        auto intern(const String & str) -> String;
+
+        ///Replaces a string value with the pooled one. Other values are left as they are.
+        void intern(Scalar & value) {
+            if (auto str = get<String>(&value))
+                *str = intern(*str);
+        }
+
+        auto statistics() const noexcept -> const Statistics &
+            { return m_statistics; }
+
+        ///Whether the pool has doubled in size since the last purge
+        auto needsPurge() const noexcept -> bool
+            { return m_strings.size() >= m_purgeThreshold; }
+
+        /**
+         Drops the pooled strings that are no longer in use.
+
+         forEachLive(report) must call report(str) for every string still in use outside of the pool.
+         Dropping a string only means that strings interned later will not share storage with it.
+         */
+        template<class ForEachLive>
+        void purge(ForEachLive && forEachLive) {
+            decltype(m_strings) live;
+            size_t liveStorageSize = 0;
+            std::forward<ForEachLive>(forEachLive)([&](const String & str) {
+                if (auto it = m_strings.find(str); it != m_strings.end() && live.insert(*it).second)
+                    liveStorageSize += storageSize(*it);
+            });
+            m_strings = std::move(live);
+            m_statistics.distinctCount = m_strings.size();
+            m_statistics.storageSize = liveStorageSize;
+            m_purgeThreshold = std::max(s_minPurgeThreshold, 2 * m_strings.size());
+        }
+
+        void clear() noexcept;
+
+    private:
+        static auto storageSize(const String & str) noexcept -> size_t
+            { return str.storage_size() * sizeof(String::storage_type); }
+
+    private:
+        static constexpr size_t s_minPurgeThreshold = 1024;
+
+        std::unordered_set<String, std::hash<String>, StringEqual> m_strings;
+        Statistics m_statistics;
+        size_t m_purgeThreshold = s_minPurgeThreshold;
+    };
+}
+
+#endif
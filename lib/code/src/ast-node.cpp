@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
 #include <spreader/ast-node.h>
+#include <spreader/bytecode.h>
 #include <spreader/cell-grid.h>
 
 #include <formula-parser.h>
@@ -11,11 +12,45 @@
 using namespace Spreader;
 
 
+auto AstNode::compile(BytecodeBuilder & /*builder*/) const -> bool {
+    return false;
+}
+
 void AstNode::reconstructPrefix(const ReconstructionContext & /*context*/, StringBuilder & /*dest*/) const {
 }
 void AstNode::reconstructSuffix(const ReconstructionContext & /*context*/, StringBuilder & /*dest*/) const {
 }
 
+void AstNode::reconstruct(const ReconstructionContext & context, StringBuilder & dest) const {
+
+    using Traversal = AstReconstructionTraversal;
+
+    Traversal traversal(*this);
+    [[maybe_unused]]
+    auto res = traversal.traverse([&context, &dest](auto && event){ 
+
+        using EventType = std::remove_cvref_t<decltype(event)>;
+
+        if constexpr (std::is_same_v<EventType, typename Traversal::Enter>) {
+            if (event.stackEntry->node->isBracketed())
+                dest.append(U'(');
+            event.stackEntry->node->reconstructPrefix(context, dest);
+        } else if constexpr (std::is_same_v<EventType, typename Traversal::AfterChild>) {
+            SPR_ASSERT_LOGIC(dynamic_cast<const FunctionNode *>(event.stackEntry->node));
+            auto function = static_cast<const FunctionNode *>(event.stackEntry->node);
+            auto * functionEntry = static_cast<FunctionNode::ReconstructionStackEntry *>(event.stackEntry);
+
+            function->reconstructAfterChild(context, functionEntry->handledChildIdx++, dest);
+        } else if constexpr (std::is_same_v<EventType, typename Traversal::Exit>) {
+            event.stackEntry->node->reconstructSuffix(context, dest);
+            if (event.stackEntry->node->isBracketed())
+                dest.append(U')');
+        }
+        return TraversalEventOutcome::Continue;
+    });
+    SPR_ASSERT_LOGIC(res == Traversal::Done);
+}
+
 auto AstNode::createExecutionStackEntry(ExecutionMemoryResource & mem, TreeTraversalState state) const -> ExecutionStackEntryPtr {
     return ExecutionStackEntryPtr(new (mem) ExecutionStackEntry(this, state));
 }
@@ -64,6 +99,11 @@ auto ScalarNode::execute(ExecutionContext & context) const -> bool {
     return true;
 }
 
+auto ScalarNode::compile(BytecodeBuilder & builder) const -> bool {
+    builder.addConstant(m_value);
+    return true;
+}
+
 void ScalarNode::reconstructPrefix(const ReconstructionContext & /*context*/, StringBuilder & dest) const {
     m_value.reconstruct(dest);
 }
@@ -133,6 +173,15 @@ auto ReferenceNode::execute(ExecutionContext & context) const -> bool {
     return true;
 }
 
+auto ReferenceNode::compile(BytecodeBuilder & builder) const -> bool {
+    
+    auto typeId = (*builder.references())[m_refIndex].typeId();
+    if (typeId != CellReference::TypeId && typeId != IllegalReference::TypeId)
+        return false;
+    builder.addReference(m_refIndex);
+    return true;
+}
+
 void ReferenceNode::reconstructPrefix(const ReconstructionContext & context, StringBuilder & dest) const {
     const auto & ref = (*context.references)[m_refIndex];
     visit([&](auto && value) {
@@ -156,11 +205,57 @@ auto ParseErrorNode::execute(ExecutionContext & context) const -> bool {
     return true;
 }
 
+auto ParseErrorNode::compile(BytecodeBuilder & builder) const -> bool {
+    builder.addConstant(m_value);
+    return true;
+}
+
 void ParseErrorNode::reconstructPrefix(const ReconstructionContext & /*context*/, StringBuilder & dest) const {
     dest.append(m_originalText);
 }
 
 
+//MARK: - FoldedNode
+
+void FoldedNode::unfoldChildren(AstNode & node) noexcept {
+
+    for (auto * slot = &node.m_firstChild; *slot; slot = &(*slot)->m_nextSibling) {
+        
+        auto * folded = dynamic_cast<FoldedNode *>(slot->get());
+        if (!folded)
+            continue;
+
+        AstNodePtr original = std::move(folded->m_original);
+        //brackets are applied after folding so they are on the folded node
+        if (folded->isBracketed())
+            original->setBracketed(true);
+        original->m_parent = folded->m_parent;
+        original->m_nextSibling = std::move(folded->m_nextSibling);
+        if (original->m_nextSibling)
+            original->m_nextSibling->m_parent = original.get();
+        *slot = std::move(original);
+    }
+}
+
+auto FoldedNode::execute(ExecutionContext & context) const -> bool {
+    context.returnedValue = m_value;
+    context.returnedExtent = m_extent;
+    return true;
+}
+
+auto FoldedNode::compile(BytecodeBuilder & builder) const -> bool {
+    auto value = get<Scalar>(&m_value);
+    if (!value)
+        return false;
+    builder.addConstant(*value);
+    return true;
+}
+
+void FoldedNode::reconstructPrefix(const ReconstructionContext & context, StringBuilder & dest) const {
+    m_original->reconstruct(context, dest);
+}
+
+
 //MARK: - FunctionNode
 
 auto FunctionNode::createExecutionStackEntry(ExecutionMemoryResource & mem, TreeTraversalState state) const -> ExecutionStackEntryPtr {
@@ -0,0 +1,252 @@
+// Copyright (c) 2022, Eugene Gershnik
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <spreader/bytecode.h>
+#include <spreader/ast-node.h>
+
+#include "execution-context.h"
+#include "scalar-numeric-functions.h"
+#include "scalar-string-functions.h"
+
+#include <cmath>
+#include <limits>
+#include <optional>
+
+using namespace Spreader;
+
+namespace {
+
+    template<class Op>
+    SPR_ALWAYS_INLINE void applyUnary(Scalar & arg) {
+        arg = Op().handleArg(std::move(arg));
+    }
+
+    template<class Op>
+    SPR_ALWAYS_INLINE void applyBinary(Scalar & lhs, Scalar & rhs) {
+        Op op;
+        op.handleFirst(std::move(lhs));
+        op.handleSecond(std::move(rhs));
+        lhs = std::move(op.result);
+    }
+}
+
+auto Bytecode::selectBranch(const Instruction & instruction, Scalar & selector) -> uint32_t {
+
+    uint32_t branch = instruction.operand;
+    if (instruction.code == OpCode::If) {
+        std::optional<Error> error;
+        applyVisitorCoercedTo<bool>([&](auto val)  {
+
+            using T = std::remove_cvref_t<decltype(val)>;
+
+            if constexpr (std::is_same_v<T, bool>) {
+                branch = !val;
+            } else if constexpr (std::is_same_v<T, Error>) {
+                error = val;
+            }
+
+        }, selector);
+        if (error)
+            selector = *error;
+    } else {
+        SPR_ASSERT_LOGIC(instruction.code == OpCode::Choose);
+        Scalar value = Error::InvalidValue;
+        applyVisitorCoercedTo<Number>([&](auto val)  {
+
+            using T = std::remove_cvref_t<decltype(val)>;
+
+            if constexpr (std::is_same_v<T, Number>) {
+                //same limits as the full CHOOSE implementation
+                if (val.value() > 0 && std::trunc(val.value()) < std::numeric_limits<uint16_t>::max()) {
+                    auto idx = uint16_t(val.value());
+                    if (idx > 0 && idx <= instruction.operand)
+                        branch = idx - 1;
+                }
+            } else if constexpr (std::is_same_v<T, Error>) {
+                value = val;
+            }
+
+        }, selector);
+        if (branch == instruction.operand)
+            selector = std::move(value);
+    }
+    return branch;
+}
+
+auto Bytecode::compile(const AstNode & root, const FormulaReferences * refs) -> Bytecode {
+
+    BytecodeBuilder builder(refs);
+    if (!builder.add(root) || builder.m_tooDeep)
+        return Bytecode();
+    SPR_ASSERT_LOGIC(builder.m_depth == 1);
+    return std::move(builder.m_result);
+}
+
+auto Bytecode::run(ExecutionContext & context, Scalar & result) const -> bool {
+
+    Scalar stack[maxStackDepth];
+    size_t top = 0;
+
+    const auto * code = m_code.data();
+    const auto * const end = code + m_code.size();
+    while (code != end) {
+
+        auto & instruction = *code++;
+        switch (instruction.code) {
+
+            case OpCode::PushConstant:
+                stack[top++] = m_constants[instruction.operand];
+                break;
+
+            case OpCode::PushReference: {
+                const auto & ref = context.references()[instruction.operand];
+                bool available = visit([&](auto && value) {
+
+                    using RefType = std::remove_cvref_t<decltype(value)>;
+
+                    if constexpr (std::is_same_v<RefType, CellReference>) {
+                        return context.evaluateCell(value.dereference(context.at()), [&](const Scalar & cellVal) {
+                            stack[top++] = cellVal;
+                            return true;
+                        }, [](bool /*isCircular*/) {
+                            return false;
+                        });
+                    } else {
+                        //only cell references are compiled and adjusting them can only make them illegal
+                        SPR_ASSERT_LOGIC((std::is_same_v<RefType, IllegalReference>));
+                        stack[top++] = Error::InvalidReference;
+                        return true;
+                    }
+                }, ref);
+                if (!available)
+                    return false;
+                break;
+            }
+
+            case OpCode::Negate:        applyUnary<ScalarNegate>(stack[top - 1]); break;
+            case OpCode::Affirm:        applyUnary<ScalarAffirm>(stack[top - 1]); break;
+            case OpCode::Percent:       applyUnary<ScalarPercent>(stack[top - 1]); break;
+
+            case OpCode::Add:           applyBinary<ScalarAdd>(stack[top - 2], stack[top - 1]); --top; break;
+            case OpCode::Subtract:      applyBinary<ScalarSubtract>(stack[top - 2], stack[top - 1]); --top; break;
+            case OpCode::Multiply:      applyBinary<ScalarMultiply>(stack[top - 2], stack[top - 1]); --top; break;
+            case OpCode::Divide:        applyBinary<ScalarDivide>(stack[top - 2], stack[top - 1]); --top; break;
+            case OpCode::Power:         applyBinary<ScalarPower>(stack[top - 2], stack[top - 1]); --top; break;
+            case OpCode::Ampersand:     applyBinary<ScalarAmpersand>(stack[top - 2], stack[top - 1]); --top; break;
+            case OpCode::Equals:        applyBinary<ScalarEquals>(stack[top - 2], stack[top - 1]); --top; break;
+            case OpCode::NotEquals:     applyBinary<ScalarNotEquals>(stack[top - 2], stack[top - 1]); --top; break;
+            case OpCode::Greater:       applyBinary<ScalarGreater>(stack[top - 2], stack[top - 1]); --top; break;
+            case OpCode::GreaterEquals: applyBinary<ScalarGreaterEquals>(stack[top - 2], stack[top - 1]); --top; break;
+            case OpCode::Less:          applyBinary<ScalarLess>(stack[top - 2], stack[top - 1]); --top; break;
+            case OpCode::LessEquals:    applyBinary<ScalarLessEquals>(stack[top - 2], stack[top - 1]); --top; break;
+
+            case OpCode::If:
+            case OpCode::Choose: {
+                auto branch = selectBranch(instruction, stack[top - 1]);
+                if (branch != instruction.operand)
+                    --top;
+                code += branch;
+                break;
+            }
+
+            case OpCode::Jump:
+                code = m_code.data() + instruction.operand;
+                break;
+        }
+    }
+
+    SPR_ASSERT_LOGIC(top == 1);
+    result = std::move(stack[0]);
+    return true;
+}
+
+auto BytecodeBuilder::add(const AstNode & node) -> bool {
+
+    //the AST can be arbitrarily deep while compiling it is recursive
+    if (m_nesting == s_maxNesting)
+        return false;
+    ++m_nesting;
+    bool ret = node.compile(*this);
+    --m_nesting;
+    return ret;
+}
+
+void BytecodeBuilder::addConstant(const Scalar & value) {
+    emit(Bytecode::OpCode::PushConstant, uint32_t(m_result.m_constants.size()));
+    m_result.m_constants.push_back(value);
+    push();
+}
+
+void BytecodeBuilder::addReference(size_t refIndex) {
+    emit(Bytecode::OpCode::PushReference, uint32_t(refIndex));
+    push();
+}
+
+void BytecodeBuilder::addOperator(Bytecode::OpCode code) {
+    SPR_ASSERT_LOGIC(code >= Bytecode::OpCode::Negate && code <= Bytecode::OpCode::LessEquals);
+    if (code >= Bytecode::OpCode::Add)
+        pop(1);
+    emit(code);
+}
+
+auto BytecodeBuilder::addBranches(Bytecode::OpCode code, const AstNode & selector, size_t count) -> bool {
+
+    SPR_ASSERT_LOGIC(code == Bytecode::OpCode::If || code == Bytecode::OpCode::Choose);
+
+    auto selectorStart = m_result.m_code.size();
+    if (!add(selector))
+        return false;
+
+    //a constant selector, usually a folded one, picks the branch right away
+    if (m_result.m_code.size() == selectorStart + 1 && m_result.m_code.back().code == Bytecode::OpCode::PushConstant) {
+        auto & value = m_result.m_constants[m_result.m_code.back().operand];
+        auto branchIdx = Bytecode::selectBranch({code, uint32_t(count)}, value);
+        if (branchIdx == count)
+            return true;
+        m_result.m_code.pop_back();
+        m_result.m_constants.pop_back();
+        pop(1);
+        const AstNode * branch = &selector;
+        for (size_t i = 0; i <= branchIdx; ++i)
+            branch = AstNode::TraversalAccessBase::nextSibling(branch);
+        SPR_ASSERT_LOGIC(branch);
+        return add(*branch);
+    }
+
+    pop(1);
+    emit(code, uint32_t(count));
+    
+    //jump table: one entry per branch and the final one to the end
+    auto table = m_result.m_code.size();
+    for (size_t i = 0; i <= count; ++i)
+        emit(Bytecode::OpCode::Jump);
+
+    auto depth = m_depth;
+    std::vector<size_t> exits;
+    exits.reserve(count);
+    
+    const AstNode * branch = &selector;
+    for (size_t i = 0; i < count; ++i) {
+        branch = AstNode::TraversalAccessBase::nextSibling(branch);
+        SPR_ASSERT_LOGIC(branch);
+        m_result.m_code[table + i].operand = uint32_t(m_result.m_code.size());
+        m_depth = depth;
+        if (!add(*branch))
+            return false;
+        exits.push_back(m_result.m_code.size());
+        emit(Bytecode::OpCode::Jump);
+    }
+
+    auto end = uint32_t(m_result.m_code.size());
+    m_result.m_code[table + count].operand = end;
+    for (auto exit: exits)
+        m_result.m_code[exit].operand = end;
+    m_depth = depth;
+    push();
+    return true;
+}
+
+void BytecodeBuilder::push() {
+    if (++m_depth > Bytecode::maxStackDepth)
+        m_tooDeep = true;
+}
@@ -5,7 +5,7 @@
 
 using namespace Spreader;
 
-auto CellGrid::getCell(Point coord) const noexcept -> Cell * {
+auto CellGrid::getCell(Point coord) const noexcept -> CellRef {
 
     SPR_ASSERT_INPUT(coord.x < s_maxSize.width && coord.y < s_maxSize.height);
     
@@ -15,6 +15,99 @@ auto CellGrid::getCell(Point coord) const noexcept -> Cell * {
     return m_topTile->get(coord);
 } 
 
+CellGrid::LeafStorage::~LeafStorage() noexcept {
+    if (m_dense) {
+        for (size_t i = 0; i < s_cellCount; ++i)
+            reinterpret_cast<CellPtr &>(m_dense[i]).reset();
+    } else {
+        for (auto & entry: m_sparse)
+            reinterpret_cast<CellPtr &>(entry.cell).reset();
+    }
+}
 
+void CellGrid::LeafStorage::store(PendingSlot & pending, bool hasEntry) {
 
+    //nested modifications could have promoted the storage or moved the entries
+    if (m_dense) {
+        if (pending.cell)
+            m_dense[pending.index] = pending.cell.release();
+        return;
+    }
+    auto it = lowerBound(pending.index);
+    if (hasEntry) {
+        SPR_ASSERT_LOGIC(it != m_sparse.end() && it->index == pending.index && !it->cell);
+        if (pending.cell)
+            it->cell = pending.cell.release();
+        else
+            m_sparse.erase(it);
+        return;
+    }
+    if (!pending.cell)
+        return;
+    if (m_sparse.size() == s_maxSparseCount) {
+        promote();
+        m_dense[pending.index] = pending.cell.release();
+    } else {
+        it = m_sparse.insert(it, SparseEntry{pending.index, nullptr});
+        it->cell = pending.cell.release();
+    }
+}
 
+void CellGrid::LeafStorage::promote() {
+
+    SPR_ASSERT_LOGIC(!m_dense);
+
+    m_dense.reset(new CellRef[s_cellCount]());
+    for (auto & entry: m_sparse)
+        m_dense[entry.index] = entry.cell;
+    std::vector<SparseEntry>().swap(m_sparse);
+}
+
+auto CellGrid::findBandLeaves(Rect rect, SizeType y, BandLeaves & leaves) const -> SizeType {
+
+    const Point end = rect.end();
+    const SizeType bandEnd = std::min(end.y, (y | s_leafMask.height) + 1);
+    SizeType emptyEnd = end.y;
+
+    leaves.clear();
+    for (SizeType x = rect.origin.x; x < end.x; ) {
+        Size emptyExtent;
+        if (auto * leaf = m_topTile->findLeaf(Point{x, y}, emptyExtent)) {
+            leaves.add({x, leaf});
+            x = (x | s_leafMask.width) + 1;
+        } else {
+            x += std::min(emptyExtent.width, end.x - x);
+            emptyEnd = std::min(emptyEnd, y + std::min(emptyExtent.height, end.y - y));
+        }
+    }
+
+    //every missing tile is at least as tall as the band
+    return leaves.empty() ? emptyEnd : bandEnd;
+}
+
+auto CellGrid::cells(Rect rect) const -> CoroGenerator<std::pair<Point, CellRef>> {
+
+    if (!m_topTile)
+        co_return;
+
+    rect = clampToSize(rect);
+    const Point end = rect.end();
+    BandLeaves leaves;
+    for (SizeType y = rect.origin.y; y < end.y; ) {
+
+        const SizeType bandEnd = findBandLeaves(rect, y, leaves);
+        if (leaves.empty()) {
+            y = bandEnd;
+            continue;
+        }
+        for ( ; y < bandEnd; ++y) {
+            for (auto [chunkX, leaf]: leaves) {
+                const SizeType base = chunkX & ~s_leafMask.width;
+                const SizeType chunkEnd = std::min(end.x, (chunkX | s_leafMask.width) + 1);
+                Point local{chunkX - base, y & s_leafMask.height};
+                for ( ; auto cell = leaf->findInRow(local, chunkEnd - base); ++local.x)
+                    co_yield std::pair(Point{base + local.x, y}, cell);
+            }
+        }
+    }
+}
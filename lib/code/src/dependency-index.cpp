@@ -0,0 +1,222 @@
+// Copyright (c) 2022, Eugene Gershnik
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <spreader/dependency-index.h>
+#include <spreader/cell-grid.h>
+
+using namespace Spreader;
+
+auto DependencyIndex::precedentOf(const FormulaReferences::Entry & ref, Point location) noexcept -> std::optional<Precedent> {
+
+    const Size maxSize = CellGrid::maxSize();
+
+    auto clamp = [&](Rect rect) {
+        rect.size.width = std::min(rect.size.width, maxSize.width - rect.origin.x);
+        rect.size.height = std::min(rect.size.height, maxSize.height - rect.origin.y);
+        return rect;
+    };
+
+    return visit([&](auto && value) -> std::optional<Precedent> {
+
+        using RefType = std::remove_cvref_t<decltype(value)>;
+
+        if constexpr (std::is_same_v<RefType, IllegalReference>) {
+            return std::nullopt;
+        } else if constexpr (std::is_same_v<RefType, CellReference>) {
+            return Precedent{Rect{value.dereference(location), Size{1, 1}}, false};
+        } else if constexpr (std::is_same_v<RefType, AreaReference>) {
+            return Precedent{clamp(value.dereference(location)), false};
+        } else if constexpr (std::is_same_v<RefType, ColumnReference>) {
+            auto [start, size] = value.dereference(location);
+            return Precedent{clamp(Rect{Point{start, 0}, Size{size, maxSize.height}}), true};
+        } else if constexpr (std::is_same_v<RefType, RowReference>) {
+            auto [start, size] = value.dereference(location);
+            return Precedent{clamp(Rect{Point{0, start}, Size{maxSize.width, size}}), true};
+        }
+    }, ref);
+}
+
+template<class Func>
+void DependencyIndex::forEachPrecedent(const Registration & reg, Func && func) {
+
+    for (auto & ref: *reg.references) {
+        if (auto precedent = precedentOf(ref, reg.location))
+            func(precedent->rect, precedent->dependsOnSize);
+    }
+}
+
+auto DependencyIndex::groupPrecedentOf(const Group & group, size_t refIndex) noexcept -> std::optional<Precedent> {
+
+    //see dependentArea() for why the corners of the area are enough
+    const auto & ref = (*group.references)[refIndex];
+    auto first = precedentOf(ref, group.area.origin);
+    if (!first)
+        return std::nullopt;
+    auto last = precedentOf(ref, group.area.end() - Size{1, 1});
+    SPR_ASSERT_LOGIC(last);
+    return Precedent{boundingRect(first->rect, last->rect), first->dependsOnSize};
+}
+
+auto DependencyIndex::dependentArea(const Group & group, size_t refIndex, Rect rect) noexcept -> Rect {
+
+    const auto & ref = (*group.references)[refIndex];
+    const Rect & area = group.area;
+
+    //The x extent of a precedent depends only on the x of its formula location and never moves left 
+    //as the location moves right (same for y). Thus the locations that reference something in the rect 
+    //form a contiguous range in each dimension which can be found via binary search.
+    auto firstWhere = [](SizeType count, auto pred) -> SizeType {
+        SizeType first = 0;
+        while (count > 0) {
+            SizeType step = count / 2;
+            if (!pred(first + step)) {
+                first += step + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+        return first;
+    };
+    auto precedentAt = [&](Point location) {
+        auto ret = precedentOf(ref, location);
+        SPR_ASSERT_LOGIC(ret);
+        return ret->rect;
+    };
+
+    auto xStart = firstWhere(area.size.width, [&](SizeType dx) {
+        auto prec = precedentAt(Point{area.origin.x + dx, area.origin.y});
+        return prec.origin.x + prec.size.width > rect.origin.x;
+    });
+    auto xEnd = firstWhere(area.size.width, [&](SizeType dx) {
+        auto prec = precedentAt(Point{area.origin.x + dx, area.origin.y});
+        return prec.origin.x >= rect.origin.x + rect.size.width;
+    });
+    auto yStart = firstWhere(area.size.height, [&](SizeType dy) {
+        auto prec = precedentAt(Point{area.origin.x, area.origin.y + dy});
+        return prec.origin.y + prec.size.height > rect.origin.y;
+    });
+    auto yEnd = firstWhere(area.size.height, [&](SizeType dy) {
+        auto prec = precedentAt(Point{area.origin.x, area.origin.y + dy});
+        return prec.origin.y >= rect.origin.y + rect.size.height;
+    });
+
+    if (xStart >= xEnd || yStart >= yEnd)
+        return Rect{area.origin, Size{0, 0}};
+    return Rect{area.origin + Size{xStart, yStart}, Size{xEnd - xStart, yEnd - yStart}};
+}
+
+void DependencyIndex::add(FormulaCell * cell) {
+
+    remove(cell);
+
+    if (cell->formula()->isVolatile())
+        m_volatiles.insert(cell);
+
+    if (!cell->references())
+        return;
+
+    auto [it, _] = m_registrations.emplace(cell, Registration{cell->references(), cell->location()});
+    forEachPrecedent(it->second, [&](Rect rect, bool dependsOnSize) {
+        if (rect.size == Size{1, 1})
+            m_cellDependents.emplace(rect.origin, cell);
+        else
+            m_areaPrecedents.insert(rect, cell);
+        if (dependsOnSize)
+            m_sizeDependents.insert(cell);
+    });
+}
+
+void DependencyIndex::remove(FormulaCell * cell) {
+
+    m_volatiles.erase(cell);
+
+    auto it = m_registrations.find(cell);
+    if (it == m_registrations.end()) {
+        removeFromGroup(cell);
+        return;
+    }
+
+    forEachPrecedent(it->second, [&](Rect rect, bool /*dependsOnSize*/) {
+        if (rect.size != Size{1, 1}) {
+            m_areaPrecedents.erase(rect, cell);
+            return;
+        }
+        auto [first, last] = m_cellDependents.equal_range(rect.origin);
+        for ( ; first != last; ++first) {
+            if (first->second == cell) {
+                m_cellDependents.erase(first);
+                break;
+            }
+        }
+    });
+    m_sizeDependents.erase(cell);
+    m_registrations.erase(it);
+}
+
+void DependencyIndex::clear() noexcept {
+    m_registrations.clear();
+    m_cellDependents.clear();
+    m_areaPrecedents.clear();
+    m_sizeDependents.clear();
+    m_volatiles.clear();
+    m_groupPrecedents.clear();
+    m_groupAreas.clear();
+    m_groups.clear();
+}
+
+void DependencyIndex::addGroup(Rect area, std::vector<FormulaCell *> && cells) {
+
+    SPR_ASSERT_LOGIC(cells.size() == size_t(area.size.width) * area.size.height);
+    SPR_ASSERT_LOGIC(cells[0]->references());
+
+    for (auto cell: cells) {
+        if (cell->formula()->isVolatile())
+            m_volatiles.insert(cell);
+    }
+
+    auto & group = m_groups.emplace_back(Group{
+        .references = cells[0]->references(), 
+        .area = area, 
+        .members = std::move(cells), 
+        .count = size_t(area.size.width) * area.size.height
+    });
+
+    for (size_t i = 0; i < group.references->size(); ++i) {
+        if (auto precedent = groupPrecedentOf(group, i)) {
+            m_groupPrecedents.insert(precedent->rect, GroupReference{&group, i});
+            group.dependsOnSize |= precedent->dependsOnSize;
+        }
+    }
+    m_groupAreas.insert(area, &group);
+}
+
+void DependencyIndex::removeFromGroup(FormulaCell * cell) {
+
+    const Point location = cell->location();
+    Group * group = nullptr;
+    m_groupAreas.forEachIntersecting(Rect{location, Size{1, 1}}, [&](Rect, Group * candidate) {
+        if (candidate->members[candidate->indexOf(location)] == cell)
+            group = candidate;
+    });
+    if (!group)
+        return;
+
+    group->members[group->indexOf(location)] = nullptr;
+    if (--group->count != 0)
+        return;
+
+    for (size_t i = 0; i < group->references->size(); ++i) {
+        if (auto precedent = groupPrecedentOf(*group, i))
+            m_groupPrecedents.erase(precedent->rect, GroupReference{group, i});
+    }
+    m_groupAreas.erase(group->area, group);
+    m_groups.remove_if([group](const Group & item) { return &item == group; });
+}
+
+void DependencyIndex::setVolatile(FormulaCell * cell, bool value) {
+    if (value)
+        m_volatiles.insert(cell);
+    else
+        m_volatiles.erase(cell);
+}
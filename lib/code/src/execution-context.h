@@ -6,6 +6,9 @@
 
 #include <spreader/formula-references.h>
 #include <spreader/cell-grid.h>
+#include <spreader/lookup-index.h>
+
+#include <span>
 
 namespace Spreader {
 
@@ -48,11 +51,14 @@ namespace Spreader {
     private:
         //environment
         DependencyHandler * m_dependencyHandler = nullptr;
+        LookupIndexCache * m_lookupIndices = nullptr;
         CellGrid * m_grid;
         NameManager * m_names;
         const FormulaReferences * m_references;
         Point m_at;
         bool m_generation;
+
+        static constexpr size_t s_numberBlockSize = 256;
         
     public:
         
@@ -91,25 +97,61 @@ namespace Spreader {
         void setDependencyHandler(DependencyHandler * depHandler) {
             m_dependencyHandler = depHandler;
         }
+
+        ///Null when lookups must not use (or build) shared indices
+        auto lookupIndices() const noexcept -> LookupIndexCache * { return this->m_lookupIndices; }
+        void setLookupIndices(LookupIndexCache * indices) {
+            m_lookupIndices = indices;
+        }
         
         template<class SuccessHandler, class DependencyHandler>
         SPR_ALWAYS_INLINE auto evaluateCell(Point pt, SuccessHandler onSuccess, DependencyHandler onDependency) {
             
-            if (auto * cell = this->m_grid->getCell(pt)) {
-                if (auto dependency = getRecalcDependency(cell, this->m_generation)) {
-                    if (dependency->isCircularDependency()) {
-                        this->circularDependency = true;
-                        return onDependency(true);
-                    } else {
-                        this->m_dependencyHandler->addDependency(dependency);
-                        return onDependency(false);
-                    }
+            if (auto cell = this->m_grid->getCell(pt))
+                return evaluateCell(cell, onSuccess, onDependency);
+            return onSuccess(Scalar{});
+        }
+
+        template<class SuccessHandler, class DependencyHandler>
+        SPR_ALWAYS_INLINE auto evaluateCell(CellRef cell, SuccessHandler onSuccess, DependencyHandler onDependency) {
+            
+            if (auto dependency = getRecalcDependency(cell, this->m_generation)) {
+                if (dependency->isCircularDependency(this->m_generation)) {
+                    this->circularDependency = true;
+                    return onDependency(true);
+                } else {
+                    this->m_dependencyHandler->addDependency(dependency);
+                    return onDependency(false);
                 }
-                return onSuccess(cell->value());
             }
-            return onSuccess(Scalar{});
+            return cell.withValue(onSuccess);
+        }
+        
+        ///Calls onSuccess with the cell value if it is up to date. Unlike evaluateCell() does not report dependencies.
+        template<class SuccessHandler>
+        SPR_ALWAYS_INLINE auto peekCell(CellRef cell, SuccessHandler onSuccess) -> bool {
+            
+            if (getRecalcDependency(cell, this->m_generation))
+                return false;
+            cell.withValue(onSuccess);
+            return true;
         }
         
+        ///The formula cell that needs to be calculated before the cell value can be used, if any
+        SPR_ALWAYS_INLINE auto getDependency(CellRef cell) const noexcept -> FormulaCell * {
+            return getRecalcDependency(cell, this->m_generation);
+        }
+
+        ///Reports a dependency returned by getDependency(). Returns false if it is circular.
+        auto addDependency(FormulaCell * dependency) -> bool {
+            if (dependency->isCircularDependency(this->m_generation)) {
+                this->circularDependency = true;
+                return false;
+            }
+            this->m_dependencyHandler->addDependency(dependency);
+            return true;
+        }
+
         SPR_ALWAYS_INLINE static auto generateScalar(const ArrayPtr & arr, Point off) -> Scalar {
             if (arr->size().width == 1)
                 off.x = 0;
@@ -224,33 +266,94 @@ namespace Spreader {
             HasDependencies
         };
 
+        /**
+         Calls op with the value of every cell of rect in row-major order until it returns false.
+         
+         Existing cells are found via a tile traversal of the grid rather than a lookup per cell. 
+         If skipBlanks is true op is not called for missing cells at all so the cost only depends on
+         the populated part of the rect. This is only valid for ops that ignore blank values.
+
+         If op can also be called with std::span<const double> runs of numbers stored inline in the grid 
+         are passed to it in blocks of up to s_numberBlockSize, without constructing a Scalar for each.
+         */
         template<class Op>
-        auto aggregateRect(Rect rect, Op op) -> AggregateRectResult {
+        auto aggregateRect(Rect rect, Op op, bool skipBlanks = false) -> AggregateRectResult {
+
+            constexpr bool takesNumbers = std::is_invocable_r_v<bool, Op &, std::span<const double>>;
 
-            auto clampedSize = Size {
+            rect.size = Size {
                 std::min(this->m_grid->maxSize().width - rect.origin.x, rect.size.width),
                 std::min(this->m_grid->maxSize().height - rect.origin.y, rect.size.height)
             };
+            if (rect.size.width == 0 || rect.size.height == 0)
+                return AggregateRectResult::Success;
+
             AggregateRectResult ret = AggregateRectResult::Success;
-            Point pt;
-            for(pt.y = rect.origin.y; pt.y < rect.origin.y + clampedSize.height; ++pt.y) {
-                for(pt.x = rect.origin.x; pt.x < rect.origin.x + clampedSize.width; ++pt.x) {
-                    
-                    bool shouldContinue = evaluateCell(pt, [&](const Scalar & cellVal) {
-                        if ((ret == AggregateRectResult::Success) && !op(cellVal)) {
-                            ret = AggregateRectResult::Aborted;
-                            return false;
-                        }
+            const Point end = rect.end();
+            Point next = rect.origin;
+            auto advance = [&](Point pt) {
+                next = pt;
+                if (++next.x == end.x) {
+                    next.x = rect.origin.x;
+                    ++next.y;
+                }
+            };
+            double numbers[takesNumbers ? s_numberBlockSize : 1];
+            size_t numberCount = 0;
+            auto flushNumbers = [&]() -> bool {
+                if constexpr (takesNumbers) {
+                    if (numberCount == 0 || ret != AggregateRectResult::Success)
                         return true;
-                    }, [&](bool isCircular) {
-                        ret = AggregateRectResult::HasDependencies;
-                        return !isCircular;
-                    });
-                    if (!shouldContinue)
-                        return ret;
-                    
+                    bool shouldContinue = op(std::span<const double>(numbers, numberCount));
+                    numberCount = 0;
+                    if (!shouldContinue) {
+                        ret = AggregateRectResult::Aborted;
+                        return false;
+                    }
                 }
-            }
+                return true;
+            };
+            auto addBlanksBefore = [&](Point pt) -> bool {
+                if (skipBlanks || ret != AggregateRectResult::Success)
+                    return true;
+                if ((next.y < pt.y || (next.y == pt.y && next.x < pt.x)) && !flushNumbers())
+                    return false;
+                while (next.y < pt.y || (next.y == pt.y && next.x < pt.x)) {
+                    if (!op(Scalar{})) {
+                        ret = AggregateRectResult::Aborted;
+                        return false;
+                    }
+                    advance(next);
+                }
+                return true;
+            };
+
+            bool completed = this->m_grid->forEachCell(rect, [&](Point pt, CellRef cell) {
+
+                if (!addBlanksBefore(pt))
+                    return false;
+                advance(pt);
+                if constexpr (takesNumbers) {
+                    if (cell.isInlineNumber() && ret == AggregateRectResult::Success) {
+                        numbers[numberCount++] = cell.inlineNumber();
+                        return numberCount < s_numberBlockSize || flushNumbers();
+                    }
+                    if (!flushNumbers())
+                        return false;
+                }
+                return evaluateCell(cell, [&](const Scalar & cellVal) {
+                    if ((ret == AggregateRectResult::Success) && !op(cellVal)) {
+                        ret = AggregateRectResult::Aborted;
+                        return false;
+                    }
+                    return true;
+                }, [&](bool isCircular) {
+                    ret = AggregateRectResult::HasDependencies;
+                    return !isCircular;
+                });
+            });
+            if (completed && flushNumbers())
+                addBlanksBefore(Point{rect.origin.x, end.y});
             return ret;
         }
 
@@ -274,12 +377,12 @@ namespace Spreader {
             for(off.height = 0; off.height < commonSize.height; ++off.height) {
 
                 for(off.width = 0; off.width < commonSize.width; ++off.width) {
-                    auto * mainCell = this->m_grid->getCell(main.origin + off);
-                    auto * secondCell = this->m_grid->getCell(second.origin + off);
+                    auto mainCell = this->m_grid->getCell(main.origin + off);
+                    auto secondCell = this->m_grid->getCell(second.origin + off);
 
                     if (mainCell) {
                         if (auto dependency = getRecalcDependency(mainCell, this->m_generation)) {
-                            if (dependency->isCircularDependency()) {
+                            if (dependency->isCircularDependency(this->m_generation)) {
                                 this->circularDependency = true;
                                 return AggregateRectResult::HasDependencies;
                             }
@@ -289,7 +392,7 @@ namespace Spreader {
                     }
                     if (secondCell) {
                         if (auto dependency = getRecalcDependency(secondCell, this->m_generation)) {
-                            if (dependency->isCircularDependency()) {
+                            if (dependency->isCircularDependency(this->m_generation)) {
                                 this->circularDependency = true;
                                 return AggregateRectResult::HasDependencies;
                             }
@@ -300,17 +403,17 @@ namespace Spreader {
 
                     if (!hasDependencies) {
 
-                        if (!op(mainCell ? mainCell->value() : Scalar(), secondCell ? secondCell->value() : Scalar()))
+                        if (!op(mainCell ? mainCell.value() : Scalar(), secondCell ? secondCell.value() : Scalar()))
                             return AggregateRectResult::Aborted;
                     }
                 }
 
                 for( ; off.width < clampedMainSize.width; ++off.width) {
 
-                    auto * mainCell = this->m_grid->getCell(main.origin + off);
+                    auto mainCell = this->m_grid->getCell(main.origin + off);
                     if (mainCell) {
                         if (auto dependency = getRecalcDependency(mainCell, this->m_generation)) {
-                            if (dependency->isCircularDependency()) {
+                            if (dependency->isCircularDependency(this->m_generation)) {
                                 this->circularDependency = true;
                                 return AggregateRectResult::HasDependencies;
                             }
@@ -321,7 +424,7 @@ namespace Spreader {
 
                     if (!hasDependencies) {
 
-                        if (!op(mainCell ? mainCell->value() : Scalar(), Scalar()))
+                        if (!op(mainCell ? mainCell.value() : Scalar(), Scalar()))
                             return AggregateRectResult::Aborted;
                     }
                 }
@@ -329,10 +432,10 @@ namespace Spreader {
             for ( ; off.height < clampedMainSize.height; ++off.height) {
                 for(off.width = 0; off.width < clampedMainSize.width; ++off.width) {
 
-                    auto * mainCell = this->m_grid->getCell(main.origin + off);
+                    auto mainCell = this->m_grid->getCell(main.origin + off);
                     if (mainCell) {
                         if (auto dependency = getRecalcDependency(mainCell, this->m_generation)) {
-                            if (dependency->isCircularDependency()) {
+                            if (dependency->isCircularDependency(this->m_generation)) {
                                 this->circularDependency = true;
                                 return AggregateRectResult::HasDependencies;
                             }
@@ -343,7 +446,7 @@ namespace Spreader {
 
                     if (!hasDependencies) {
 
-                        if (!op(mainCell ? mainCell->value() : Scalar(), Scalar()))
+                        if (!op(mainCell ? mainCell.value() : Scalar(), Scalar()))
                             return AggregateRectResult::Aborted;
                     }
                 }
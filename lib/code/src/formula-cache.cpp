@@ -0,0 +1,27 @@
+// Copyright (c) 2022, Eugene Gershnik
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <spreader/formula-cache.h>
+
+using namespace Spreader;
+
+auto FormulaCache::parse(const String & str, Point at) -> std::pair<ConstFormulaPtr, ConstFormulaReferencesPtr> {
+
+    auto key = Formula::positionIndependentKey(str, at);
+    if (key) {
+        if (auto it = m_entries.find(*key); it != m_entries.end()) {
+            ++m_statistics.hits;
+            return it->second;
+        }
+    }
+    ++m_statistics.misses;
+
+    auto ret = Formula::parse(str, at);
+    //Invalid formulas remember their original text which is specific to the location
+    if (key && !ret.first->hasSyntaxError()) {
+        if (m_entries.size() == s_maxEntries)
+            m_entries.clear();
+        m_entries.emplace(std::move(*key), ret);
+    }
+    return ret;
+}
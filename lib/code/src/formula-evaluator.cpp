@@ -12,12 +12,34 @@ FormulaEvaluator::FormulaEvaluator(AstNode::ExecutionMemoryResource & memory,
                                    const ConstFormulaReferencesPtr & refs,
                                    Point at,
                                    bool generation):
-    m_traversal(*formula, memory),
+    m_context(grid, names, refs.get(), at, generation) {
+
+    if (!formula->m_bytecode.empty())
+        m_bytecode = &formula->m_bytecode;
+    else
+        m_traversal.emplace(static_cast<const AstNode &>(*formula), memory);
+}
+
+FormulaEvaluator::FormulaEvaluator(AstNode::ExecutionMemoryResource & memory,
+                                   CellGrid & grid,
+                                   NameManager & names,
+                                   const AstNode & root,
+                                   const ConstFormulaReferencesPtr & refs,
+                                   Point at,
+                                   bool generation):
+    m_traversal(std::in_place, root, memory),
     m_context(grid, names, refs.get(), at, generation)
 {}
 
 auto FormulaEvaluator::eval() -> bool {
     
+    if (m_bytecode) {
+        if (!m_bytecode->run(m_context, m_currentValue))
+            return m_context.circularDependency;
+        m_context.returnedExtent = Size{1, 1};
+        return true;
+    }
+
     if (m_hasFullResult) {
         
         bool res = m_context.generateScalar(m_context.returnedValue, [&](const Scalar & scalar) {
@@ -26,7 +48,8 @@ auto FormulaEvaluator::eval() -> bool {
         return res || m_context.circularDependency;
     }
 
-    auto res = m_traversal.traverse([this](auto && event){
+    //a resumed evaluation might only be waiting to read the final value
+    auto res = m_traversalDone ? Traversal::Done : m_traversal->traverse([this](auto && event){
 
         using EventType = std::remove_cvref_t<decltype(event)>;
 
@@ -75,6 +98,7 @@ auto FormulaEvaluator::eval() -> bool {
     
     if (res == Traversal::Done) {
         
+        m_traversalDone = true;
         bool available = m_context.generateScalar(m_context.returnedValue, [&](const Scalar & scalar, bool isSingleItem) {
             m_currentValue = scalar;
             m_hasFullResult = !isSingleItem;
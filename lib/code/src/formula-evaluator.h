@@ -25,6 +25,14 @@ namespace Spreader {
                          const ConstFormulaReferencesPtr & refs,
                          Point at,
                          bool generation);
+        ///Evaluates a standalone expression rather than a whole formula
+        FormulaEvaluator(AstNode::ExecutionMemoryResource & memory, 
+                         CellGrid & grid, 
+                         NameManager & names,
+                         const AstNode & root, 
+                         const ConstFormulaReferencesPtr & refs,
+                         Point at,
+                         bool generation);
 
         auto eval() -> bool;
         
@@ -32,6 +40,10 @@ namespace Spreader {
             m_context.setDependencyHandler(depHandler);
         }
 
+        void setLookupIndices(LookupIndexCache * indices) {
+            m_context.setLookupIndices(indices);
+        }
+
         auto isCircularDependency() const -> bool {
             return m_context.circularDependency;
         }
@@ -56,15 +68,21 @@ namespace Spreader {
                 return false;
             SPR_ASSERT_LOGIC(m_context.suppressEvaluation == false);
             SPR_ASSERT_LOGIC(m_context.circularDependency == false);
-            if (!m_hasFullResult)
-                m_traversal.reset();
+            if (!m_hasFullResult) {
+                m_traversal->reset();
+                m_traversalDone = false;
+            }
             return true;
         }
     private:
-        Traversal m_traversal;
+        ///Not created for formulas evaluated via bytecode
+        std::optional<Traversal> m_traversal;
+        const Bytecode * m_bytecode = nullptr;
         ExecutionContext m_context;
         Scalar m_currentValue;
         bool m_hasFullResult = false;
+        ///Whether the traversal finished and only the final value is still to be read
+        bool m_traversalDone = false;
     };
     
     static_assert(std::is_move_assignable_v<FormulaEvaluator> && std::is_move_constructible_v<FormulaEvaluator>,
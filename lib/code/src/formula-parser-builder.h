@@ -7,6 +7,8 @@
 #include <spreader/ast-node.h>
 #include <spreader/formula-references.h>
 
+#include "functions/true-function.h"
+
 #include <vector>
 
 namespace Spreader::FormulaParser {
@@ -28,8 +30,23 @@ namespace Spreader::FormulaParser {
             return m_referencesBuilder.add(ref);
         }
         
+        void onFunction(FunctionId id) {
+            if (Spreader::isVolatile(id))
+                m_isVolatile = true;
+        }
+        
+        ///Replaces the node with its value if all its arguments are constant
+        auto fold(AstNodePtr && node) -> AstNodePtr;
+        auto fold(AstNodePtr && node, FunctionId id) -> AstNodePtr {
+            //these depend on where and when they are evaluated, not just on their arguments
+            if (Spreader::isVolatile(id) || id == FunctionId::Row || id == FunctionId::Column)
+                return std::move(node);
+            return fold(std::move(node));
+        }
+        
         void onSyntaxError() {
             m_referencesBuilder.reset();
+            m_isVolatile = false;
             m_root.reset(new ParseErrorNode(Error::InvalidFormula, m_original));
         }
         void onRootNode(AstNodePtr && node) {
@@ -38,12 +55,17 @@ namespace Spreader::FormulaParser {
         auto build() -> std::pair<AstNodePtr, FormulaReferencesPtr> {
             return {std::move(m_root), m_referencesBuilder.build()};
         }
+        
+        auto isVolatile() const noexcept -> bool {
+            return m_isVolatile;
+        }
 
     private:
         const String & m_original;
         const Point m_evalPoint;
         AstNodePtr m_root;
         FormulaReferencesBuilder m_referencesBuilder;
+        bool m_isVolatile = false;
     };
 
 
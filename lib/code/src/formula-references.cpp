@@ -61,6 +61,27 @@ SPR_ALWAYS_INLINE auto FormulaReferences::adjust(Func func) const -> refcnt_ptr<
     return adjuster.result();
 }
 
+auto FormulaReferences::isCopyableTo(Rect dest) const noexcept -> bool {
+
+    //Valid locations for a reference form a rectangle so checking the corners is enough
+    const Point last = dest.end() - Size{1, 1};
+    for (auto & entry: *this) {
+        bool copyable = visit([&](const auto & ref) {
+            using RefType = std::remove_cvref_t<decltype(ref)>;
+
+            if constexpr (!std::is_same_v<RefType, IllegalReference>) {
+                return ref.template isDereferencable<CellGrid::maxSize()>(dest.origin) &&
+                       ref.template isDereferencable<CellGrid::maxSize()>(last);
+            } else {
+                return true;
+            }
+        }, entry);
+        if (!copyable)
+            return false;
+    }
+    return true;
+}
+
 auto FormulaReferences::adjustToCopy(Point dest) const -> refcnt_ptr<const FormulaReferences> {
 
     return adjust([dest](Adjuster & adjuster, const auto & ref) {
@@ -5,8 +5,13 @@
 #include <formula-lexer.h>
 
 #include <spreader/formula.h>
+#include <spreader/name-manager.h>
 
-#include "execution-context.h"
+#include "formula-evaluator.h"
+
+#include <bit>
+#include <cstring>
+#include <deque>
 
 using namespace Spreader;
 
@@ -51,6 +56,45 @@ namespace Spreader::FormulaParser {
     };
 }
 
+auto FormulaParser::Builder::fold(AstNodePtr && node) -> AstNodePtr {
+
+    bool hasArguments = false;
+    for (auto child = AstNode::TraversalAccessBase::firstChild(node.get()); child; child = AstNode::TraversalAccessBase::nextSibling(child)) {
+        if (!dynamic_cast<ScalarNode *>(child) && !dynamic_cast<ArrayNode *>(child) && !dynamic_cast<FoldedNode *>(child))
+            return std::move(node);
+        hasArguments = true;
+    }
+    if (!hasArguments)
+        return std::move(node);
+
+    //Constant expressions never access the grid so an empty one will do
+    AstNode::ExecutionMemoryResource memory;
+    CellGrid grid;
+    NameManager names;
+    FormulaEvaluator evaluator(memory, grid, names, *node, nullptr, Point{0, 0}, false);
+    std::vector<Scalar> values;
+    do {
+        [[maybe_unused]] bool res = evaluator.eval();
+        SPR_ASSERT_LOGIC(res && !evaluator.isCircularDependency());
+        values.emplace_back(std::move(evaluator.result()));
+    } while (evaluator.nextOffset());
+    
+    auto extent = evaluator.extent();
+    ScalarGenerator value;
+    if (values.size() == 1) {
+        value = std::move(values[0]);
+    } else {
+        SPR_ASSERT_LOGIC(values.size() == size_t(extent.width) * extent.height);
+        value = Array::create(extent, [&values](Scalar * data) {
+            for (auto & val: values)
+                new (data++) Scalar(std::move(val));
+        });
+    }
+
+    FoldedNode::unfoldChildren(*node);
+    return AstNodePtr(new FoldedNode(std::move(value), extent, std::move(node)));
+}
+
 auto Formula::parse(String str, Point at) -> std::pair<FormulaPtr, FormulaReferencesPtr> {
 
     FormulaParser::Builder builder(str, at);
@@ -59,7 +103,87 @@ auto Formula::parse(String str, Point at) -> std::pair<FormulaPtr, FormulaRefere
     FormulaParser::Parser parser(builder, scanner.get());
     parser();
     auto res = builder.build();
-    return {refcnt_attach(new Formula(std::move(res.first))), std::move(res.second)};
+    auto formula = refcnt_attach(new Formula(std::move(res.first), builder.isVolatile(), res.second.get()));
+    return {std::move(formula), std::move(res.second)};
+}
+
+auto Formula::positionIndependentKey(const String & str, Point at) -> std::optional<std::string> {
+
+    using Parser = FormulaParser::Parser;
+    using Kind = Parser::symbol_kind;
+
+    //tokens are not copyable so they cannot be stored in a vector
+    std::deque<Parser::symbol_type> tokens;
+    {
+        FormulaParser::StringScanner scanner(str);
+        for ( ; ; ) {
+            auto token = sprflex(scanner.get());
+            if (token.kind() == Kind::S_YYEOF)
+                break;
+            if (token.kind() == Kind::S_YYUNDEF)
+                return std::nullopt;
+            tokens.emplace_back(std::move(token));
+        }
+    }
+
+    const auto dollar = Parser::symbol_type('$').kind();
+    const auto colon = Parser::symbol_type(':').kind();
+
+    std::string key;
+    auto append = [&key](auto val) {
+        static_assert(std::is_trivially_copyable_v<decltype(val)>);
+        char buf[sizeof(val)];
+        memcpy(buf, &val, sizeof(val));
+        key.append(buf, sizeof(val));
+    };
+    
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const auto & token = tokens[i];
+        auto kind = token.kind();
+        bool isAbsolute = (i > 0 && tokens[i - 1].kind() == dollar);
+        append(int16_t(kind));
+        switch (kind) {
+            case Kind::S_ERROR_CONSTANT:
+                append(token.value.as<Error>());
+                break;
+            case Kind::S_LOGICAL_CONSTANT:
+                append(token.value.as<bool>());
+                break;
+            case Kind::S_NUMERICAL_CONSTANT:
+            case Kind::S_PLUS_NUMERICAL_CONSTANT:
+            case Kind::S_MINUS_NUMERICAL_CONSTANT:
+                append(std::bit_cast<uint64_t>(token.value.as<double>()));
+                break;
+            case Kind::S_STRING_CONSTANT: {
+                const auto & val = token.value.as<String>();
+                append(uint64_t(val.storage_size()));
+                for (auto c: String::char_access(val))
+                    append(c);
+                break;
+            }
+            case Kind::S_FUNC_START:
+                append(token.value.as<FunctionId>());
+                break;
+            case Kind::S_COLUMN: {
+                auto x = token.value.as<SizeType>();
+                append(isAbsolute ? int64_t(x) : int64_t(x) - int64_t(at.x));
+                break;
+            }
+            case Kind::S_ROW: {
+                //Rows are references only next to the tokens below, the grammar uses any other one as a number
+                auto y = token.value.as<SizeType>();
+                bool isReference = isAbsolute ||
+                    (i > 0 && (tokens[i - 1].kind() == Kind::S_COLUMN || tokens[i - 1].kind() == colon)) ||
+                    (i + 1 < tokens.size() && tokens[i + 1].kind() == colon);
+                append(isReference);
+                append(isReference && !isAbsolute ? int64_t(y) - int64_t(at.y) : int64_t(y));
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return key;
 }
 
 auto Formula::execute(ExecutionContext & context) const -> bool {
@@ -72,11 +196,11 @@ auto Formula::execute(ExecutionContext & context) const -> bool {
         Point pt;
         for (pt.y = context.at().y; pt.y < context.at().y + context.returnedExtent.height; ++pt.y) {
             for (pt.x = context.at().x; pt.x < context.at().x + context.returnedExtent.width; ++pt.x) {
-                auto * existing = context.grid().getCell(pt);
+                auto existing = context.grid().getCell(pt);
                 bool isSpill = applyToCell(existing, [&context](auto ptr) {
                     using T = std::remove_cv_t<std::remove_pointer_t<decltype(ptr)>>;
 
-                    if constexpr (std::is_same_v<T, ValueCell>) {
+                    if constexpr (std::is_same_v<T, ValueCell> || std::is_same_v<T, InlineValueCell>) {
                         return !ptr->isBlank();
                     } else if constexpr (std::is_same_v<T, FormulaCell>) {
                         return false;
@@ -103,36 +227,11 @@ void Formula::reconstructAfterChild(const ReconstructionContext & /*context*/, u
 
 auto Formula::reconstructAt(const ConstFormulaReferencesPtr & refs, Point pt) const -> String {
 
-    using Traversal = AstReconstructionTraversal;
-
     StringBuilder builder;
-    Traversal traversal(*this);
     ReconstructionContext context {
         .references = refs,
         .at = pt
     };
-    [[maybe_unused]]
-    auto res = traversal.traverse([&context, &builder](auto && event){ 
-
-        using EventType = std::remove_cvref_t<decltype(event)>;
-
-        if constexpr (std::is_same_v<EventType, typename Traversal::Enter>) {
-            if (event.stackEntry->node->isBracketed())
-                builder.append(U'(');
-            event.stackEntry->node->reconstructPrefix(context, builder);
-        } else if constexpr (std::is_same_v<EventType, typename Traversal::AfterChild>) {
-            SPR_ASSERT_LOGIC(dynamic_cast<const FunctionNode *>(event.stackEntry->node));
-            auto function = static_cast<const FunctionNode *>(event.stackEntry->node);
-            auto * functionEntry = static_cast<FunctionNode::ReconstructionStackEntry *>(event.stackEntry);
-
-            function->reconstructAfterChild(context, functionEntry->handledChildIdx++, builder);
-        } else if constexpr (std::is_same_v<EventType, typename Traversal::Exit>) {
-            event.stackEntry->node->reconstructSuffix(context, builder);
-            if (event.stackEntry->node->isBracketed())
-                builder.append(U')');
-        }
-        return TraversalEventOutcome::Continue;
-    });
-    SPR_ASSERT_LOGIC(res == Traversal::Done);
+    reconstruct(context, builder);
     return builder.build();
 }
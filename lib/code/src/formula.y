@@ -84,28 +84,29 @@ expression:
     | scalar                                    { $$ = AstNodePtr(new ScalarNode         (std::move($1))); }
     | array                                     { $$ = std::move($1); }
     | cell_reference                            { $$ = std::move($1); } 
-    | OP_ADD expression  %prec UNARY_SIGN       { $$ = AstNodePtr(new AffirmNode         (std::move($2))); } 
-    | OP_SUB expression  %prec UNARY_SIGN       { $$ = AstNodePtr(new NegateNode         (std::move($2))); } 
-    | expression OP_POW expression              { $$ = AstNodePtr(new PowerNode          (std::move($1), std::move($3))); } 
-    | expression OP_MUL expression              { $$ = AstNodePtr(new MultiplyNode       (std::move($1), std::move($3))); } 
-    | expression OP_DIV expression              { $$ = AstNodePtr(new DivideNode         (std::move($1), std::move($3))); } 
-    | expression OP_ADD expression              { $$ = AstNodePtr(new AddNode            (std::move($1), std::move($3))); } 
-    | expression PLUS_NUMERICAL_CONSTANT        { $$ = AstNodePtr(new AddNode            (std::move($1), AstNodePtr(new ScalarNode($2)))); } 
-    | expression OP_SUB expression              { $$ = AstNodePtr(new SubtractNode       (std::move($1), std::move($3))); } 
-    | expression MINUS_NUMERICAL_CONSTANT       { $$ = AstNodePtr(new SubtractNode       (std::move($1), AstNodePtr(new ScalarNode($2)))); } 
-    | expression OP_AMP expression              { $$ = AstNodePtr(new AmpersandNode      (std::move($1), std::move($3))); }
-    | expression OP_EQ expression               { $$ = AstNodePtr(new EqualsNode         (std::move($1), std::move($3))); } 
-    | expression OP_NE expression               { $$ = AstNodePtr(new NotEqualsNode      (std::move($1), std::move($3))); } 
-    | expression OP_LT expression               { $$ = AstNodePtr(new LessNode           (std::move($1), std::move($3))); } 
-    | expression OP_LE expression               { $$ = AstNodePtr(new LessEqualsNode     (std::move($1), std::move($3))); } 
-    | expression OP_GT expression               { $$ = AstNodePtr(new GreaterNode        (std::move($1), std::move($3))); } 
-    | expression OP_GE expression               { $$ = AstNodePtr(new GreaterEqualsNode  (std::move($1), std::move($3))); } 
-    | expression OP_PCT                         { $$ = AstNodePtr(new PercentNode        (std::move($1))); } 
+    | OP_ADD expression  %prec UNARY_SIGN       { $$ = builder.fold(AstNodePtr(new AffirmNode         (std::move($2)))); } 
+    | OP_SUB expression  %prec UNARY_SIGN       { $$ = builder.fold(AstNodePtr(new NegateNode         (std::move($2)))); } 
+    | expression OP_POW expression              { $$ = builder.fold(AstNodePtr(new PowerNode          (std::move($1), std::move($3)))); } 
+    | expression OP_MUL expression              { $$ = builder.fold(AstNodePtr(new MultiplyNode       (std::move($1), std::move($3)))); } 
+    | expression OP_DIV expression              { $$ = builder.fold(AstNodePtr(new DivideNode         (std::move($1), std::move($3)))); } 
+    | expression OP_ADD expression              { $$ = builder.fold(AstNodePtr(new AddNode            (std::move($1), std::move($3)))); } 
+    | expression PLUS_NUMERICAL_CONSTANT        { $$ = builder.fold(AstNodePtr(new AddNode            (std::move($1), AstNodePtr(new ScalarNode($2))))); } 
+    | expression OP_SUB expression              { $$ = builder.fold(AstNodePtr(new SubtractNode       (std::move($1), std::move($3)))); } 
+    | expression MINUS_NUMERICAL_CONSTANT       { $$ = builder.fold(AstNodePtr(new SubtractNode       (std::move($1), AstNodePtr(new ScalarNode($2))))); } 
+    | expression OP_AMP expression              { $$ = builder.fold(AstNodePtr(new AmpersandNode      (std::move($1), std::move($3)))); }
+    | expression OP_EQ expression               { $$ = builder.fold(AstNodePtr(new EqualsNode         (std::move($1), std::move($3)))); } 
+    | expression OP_NE expression               { $$ = builder.fold(AstNodePtr(new NotEqualsNode      (std::move($1), std::move($3)))); } 
+    | expression OP_LT expression               { $$ = builder.fold(AstNodePtr(new LessNode           (std::move($1), std::move($3)))); } 
+    | expression OP_LE expression               { $$ = builder.fold(AstNodePtr(new LessEqualsNode     (std::move($1), std::move($3)))); } 
+    | expression OP_GT expression               { $$ = builder.fold(AstNodePtr(new GreaterNode        (std::move($1), std::move($3)))); } 
+    | expression OP_GE expression               { $$ = builder.fold(AstNodePtr(new GreaterEqualsNode  (std::move($1), std::move($3)))); } 
+    | expression OP_PCT                         { $$ = builder.fold(AstNodePtr(new PercentNode        (std::move($1)))); } 
     | FUNC_START argument_list ')'              { auto func = createTrueFunctionNode(*this, $1, std::move($2)); 
                                                   if (!func) {
                                                       YYERROR;
                                                   }
-                                                  $$ = std::move(func);
+                                                  builder.onFunction($1);
+                                                  $$ = builder.fold(std::move(func), $1);
                                                 }
     ;
 
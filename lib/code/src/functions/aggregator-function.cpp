@@ -22,6 +22,15 @@ namespace Spreader {
             Point savedOffset;
         };
         
+        struct RectAdder {
+            auto operator()(const Scalar & elem) -> bool 
+                { return aggregator.addIndirect(elem); }
+            auto operator()(std::span<const double> numbers) -> bool requires(requires (Aggregator & aggr) { aggr.addNumbers(numbers); })
+                { return aggregator.addNumbers(numbers); }
+
+            Aggregator & aggregator;
+        };
+        
         AggregatorFunction(ArgumentList && args) noexcept:
             Super(std::move(args)) {
         }
@@ -91,9 +100,7 @@ namespace Spreader {
                     SPR_ASSERT_LOGIC(context.returnedExtent == val.size);
 
                     auto aggrState = saveState(entry->aggregator);
-                    auto aggregateRes = context.aggregateRect(val, [entry](const Scalar & elem) {
-                        return entry->aggregator.addIndirect(elem);
-                    });
+                    auto aggregateRes = context.aggregateRect(val, RectAdder{entry->aggregator}, Aggregator::ignoresBlanks);
                     switch(aggregateRes) {
 
                         case ExecutionContext::AggregateRectResult::Success:
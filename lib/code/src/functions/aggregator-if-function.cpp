@@ -131,7 +131,7 @@ namespace Spreader {
                         return entry->aggregator.addIndirect(value);
                     }
                     return true;
-                });
+                }, !matcher(Scalar{}));
             
             if (res == ExecutionContext::AggregateRectResult::HasDependencies) {
                 restoreState(entry->aggregator, std::move(aggrState));
@@ -0,0 +1,315 @@
+// Copyright (c) 2022, Eugene Gershnik
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "true-function-creation.h"
+#include "../execution-context.h"
+#include "../scalar-numeric-aggregators.h"
+#include "../scalar-xif-matcher.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace Spreader {
+
+    ///Counts matched positions regardless of what is in them
+    class MatchCounter {
+    public:
+        void addMatch() noexcept {
+            ++m_count;
+        }
+
+        auto result() const noexcept -> Scalar {
+            if (m_error)
+                return *m_error;
+            return m_count;
+        }
+
+        auto isError() const noexcept -> bool {
+            return bool(m_error);
+        }
+
+        void setError(Error err) noexcept {
+            m_error = err;
+        }
+
+    private:
+        unsigned m_count = 0;
+        std::optional<Error> m_error;
+    };
+
+    /**
+     SUMIFS/AVERAGEIFS (HasValueRange is true) and COUNTIFS (HasValueRange is false).
+
+     All the ranges are scanned together, position by position. At each position the criteria are tried
+     one by one until one fails, starting from the one that rejected most positions so far. The remaining
+     cells of a failed position are not looked at and the dependencies of its cells are not reported. If some
+     criterion does not match blanks only the populated cells of its range are visited.
+     */
+    template<class Aggregator, bool HasValueRange>
+    class AggregatorIfsFunction : public TrueFunctionNodeBase {
+        using Super = TrueFunctionNodeBase;
+    protected:
+        struct Criterion {
+            Rect rect;
+            std::optional<XIfMatcher> matcher;
+            bool matchesBlank = false;
+            ///Number of positions this criterion was the first to fail
+            size_t rejected = 0;
+        };
+
+        struct ExecutionStackEntry : Super::ExecutionStackEntry {
+            using Super::ExecutionStackEntry::ExecutionStackEntry;
+
+            Size extent{1,1};
+            bool originalSuppressEvaluation;
+            Aggregator aggregator;
+            Rect valueRect;
+            std::vector<Criterion> criteria;
+        };
+
+        static constexpr uint16_t s_firstCriterionIdx = HasValueRange ? 1 : 0;
+        ///How often (in positions) the order of criteria is revised
+        static constexpr size_t s_reorderInterval = 1024;
+
+        AggregatorIfsFunction(ArgumentList && args) noexcept:
+            Super(std::move(args)) {
+        }
+        ~AggregatorIfsFunction() noexcept = default;
+    public:
+        void onBeforeArguments(ExecutionContext & context) const override {
+            auto entry = static_cast<ExecutionStackEntry *>(context.stackPointer);
+            entry->originalSuppressEvaluation = context.suppressEvaluation;
+
+            //every range must be followed by its criterion
+            if (!context.suppressEvaluation && (childrenCount() - s_firstCriterionIdx) % 2 != 0) {
+                entry->aggregator.setError(Error::InvalidFormula);
+                context.suppressEvaluation = true;
+            }
+        }
+
+        auto onAfterArgument(ExecutionContext & context) const -> TraversalEventOutcome override {
+
+            auto entry = static_cast<ExecutionStackEntry *>(context.stackPointer);
+
+            if (entry->handledChildIdx < s_firstCriterionIdx || (entry->handledChildIdx - s_firstCriterionIdx) % 2 == 0) {
+
+                if (!context.suppressEvaluation) {
+
+                    auto rect = toRect(context.returnedValue);
+                    if (!rect) {
+                        entry->aggregator.setError(Error::InvalidFormula);
+                        context.suppressEvaluation = true;
+                    } else if (entry->handledChildIdx < s_firstCriterionIdx) {
+                        entry->valueRect = *rect;
+                    } else {
+                        entry->criteria.emplace_back().rect = *rect;
+                    }
+                }
+                return TraversalEventOutcome::Continue;
+            }
+
+            entry->extent.extendTo(context.returnedExtent);
+
+            if (context.suppressEvaluation)
+                return TraversalEventOutcome::Continue;
+
+            auto & criterion = entry->criteria.back();
+            SPR_ASSERT_LOGIC(!criterion.matcher);
+
+            bool res = context.generateScalar(context.returnedValue, [&](const Scalar & val) {
+                criterion.matcher.emplace(val);
+                criterion.matchesBlank = (*criterion.matcher)(Scalar{});
+            });
+
+            if (!res)
+                return TraversalEventOutcome::Pause;
+
+            return TraversalEventOutcome::Continue;
+        }
+
+        auto execute(ExecutionContext & context) const -> bool override {
+
+            auto entry = static_cast<ExecutionStackEntry *>(context.stackPointer);
+
+            if (!entry->originalSuppressEvaluation) {
+
+                if (!entry->aggregator.isError()) {
+
+                    if (!calculate(context))
+                        return false;
+                }
+
+                context.returnedValue = std::move(entry->aggregator.result());
+            }
+
+            context.returnedExtent = entry->extent;
+            context.suppressEvaluation = entry->originalSuppressEvaluation;
+            return true;
+        }
+
+    private:
+        static auto toRect(const ScalarGenerator & gen) -> std::optional<Rect> {
+
+            return applyVisitor([&](const auto & val) -> std::optional<Rect> {
+
+                using T = std::remove_cvref_t<decltype(val)>;
+
+                if constexpr (std::is_same_v<T, Point>) {
+                    return Rect{val, Size{1, 1}};
+                } else if constexpr (std::is_same_v<T, Rect>) {
+                    return val;
+                } else if constexpr (std::is_same_v<T, Scalar> || std::is_same_v<T, ArrayPtr>) {
+                    return std::nullopt;
+                } else {
+                    static_assert(dependentFalse<T>, "unhandled type");
+                }
+
+            }, gen);
+        }
+
+        static auto calculate(ExecutionContext & context) -> bool {
+
+            auto entry = static_cast<ExecutionStackEntry *>(context.stackPointer);
+            auto & criteria = entry->criteria;
+
+            const Size size = HasValueRange ? entry->valueRect.size : criteria.front().rect.size;
+            if (std::any_of(criteria.begin(), criteria.end(), [&](const Criterion & criterion) {
+                    return criterion.rect.size != size;
+                })) {
+                entry->aggregator.setError(Error::InvalidValue);
+                return true;
+            }
+
+            //positions outside of the grid can only exist in some of the ranges and are ignored
+            Size scanSize = size;
+            auto clamp = [&](Point origin) {
+                scanSize.width = std::min(context.grid().maxSize().width - origin.x, scanSize.width);
+                scanSize.height = std::min(context.grid().maxSize().height - origin.y, scanSize.height);
+            };
+            if constexpr (HasValueRange)
+                clamp(entry->valueRect.origin);
+            for (auto & criterion: criteria)
+                clamp(criterion.rect.origin);
+            if (scanSize.width == 0 || scanSize.height == 0)
+                return true;
+
+            //string matching is the slowest so it goes last until we learn better
+            std::vector<size_t> order(criteria.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+                return !criteria[lhs].matcher->hasStringCriterion() && criteria[rhs].matcher->hasStringCriterion();
+            });
+
+            auto driver = std::find_if(order.begin(), order.end(), [&](size_t idx) {
+                return !criteria[idx].matchesBlank;
+            });
+            if (driver != order.end())
+                std::rotate(order.begin(), driver, driver + 1);
+            const bool isSparse = driver != order.end();
+
+            auto aggrState = saveState(entry->aggregator);
+            std::vector<FormulaCell *> dependencies;
+            bool hasDependencies = false;
+            bool isCircular = false;
+            size_t positionCount = 0;
+
+            //returns false to stop the scan
+            auto handlePosition = [&](Size off, CellRef first) -> bool {
+
+                if (++positionCount % s_reorderInterval == 0 && order.size() > 1) {
+                    //the driver stays first since positions where it fails are not even visited
+                    std::stable_sort(order.begin() + isSparse, order.end(), [&](size_t lhs, size_t rhs) {
+                        return criteria[lhs].rejected > criteria[rhs].rejected;
+                    });
+                }
+
+                dependencies.clear();
+                for (size_t i = 0; i < order.size(); ++i) {
+
+                    auto & criterion = criteria[order[i]];
+                    CellRef cell = (i == 0 && isSparse) ? first : context.grid().getCell(criterion.rect.origin + off);
+                    bool matches;
+                    if (!cell) {
+                        matches = criterion.matchesBlank;
+                    } else if (auto dependency = context.getDependency(cell)) {
+                        //the position might still fail on another criterion in which case this doesn't matter
+                        dependencies.push_back(dependency);
+                        continue;
+                    } else {
+                        matches = cell.withValue(*criterion.matcher);
+                    }
+                    if (!matches) {
+                        ++criterion.rejected;
+                        return true;
+                    }
+                }
+
+                CellRef valueCell;
+                if constexpr (HasValueRange) {
+                    valueCell = context.grid().getCell(entry->valueRect.origin + off);
+                    if (valueCell) {
+                        if (auto dependency = context.getDependency(valueCell))
+                            dependencies.push_back(dependency);
+                    }
+                }
+
+                if (!dependencies.empty()) {
+                    for (auto dependency: dependencies) {
+                        if (!context.addDependency(dependency)) {
+                            isCircular = true;
+                            return false;
+                        }
+                    }
+                    hasDependencies = true;
+                    return true;
+                }
+                if (hasDependencies)
+                    return true;
+
+                if constexpr (HasValueRange) {
+                    if (valueCell)
+                        return valueCell.withValue([&](const Scalar & value) {
+                            return entry->aggregator.addIndirect(value);
+                        });
+                } else {
+                    entry->aggregator.addMatch();
+                }
+                return true;
+            };
+
+            if (isSparse) {
+                const Point origin = criteria[order.front()].rect.origin;
+                context.grid().forEachCell(Rect{origin, scanSize}, [&](Point pt, CellRef cell) {
+                    return handlePosition(Size{pt.x - origin.x, pt.y - origin.y}, cell);
+                });
+            } else {
+                [&]() {
+                    Size off;
+                    for(off.height = 0; off.height < scanSize.height; ++off.height) {
+                        for(off.width = 0; off.width < scanSize.width; ++off.width) {
+                            if (!handlePosition(off, nullptr))
+                                return;
+                        }
+                    }
+                }();
+            }
+
+            if (hasDependencies || isCircular) {
+                restoreState(entry->aggregator, std::move(aggrState));
+                return false;
+            }
+
+            return true;
+        }
+    };
+
+    using AverageIfsFunction = AggregatorIfsFunction<ScalarAverage, /*HasValueRange*/true>;
+    using CountIfsFunction =   AggregatorIfsFunction<MatchCounter,  /*HasValueRange*/false>;
+    using SumIfsFunction =     AggregatorIfsFunction<ScalarSum,     /*HasValueRange*/true>;
+
+    SPR_MAP_FUNCTION_ID_TO_IMPL(FunctionId::AverageIfs, "AVERAGEIFS", 3, UINT_MAX, AverageIfsFunction);
+    SPR_MAP_FUNCTION_ID_TO_IMPL(FunctionId::CountIf,    "COUNTIF",    2, 2,        CountIfsFunction);
+    SPR_MAP_FUNCTION_ID_TO_IMPL(FunctionId::CountIfs,   "COUNTIFS",   2, UINT_MAX, CountIfsFunction);
+    SPR_MAP_FUNCTION_ID_TO_IMPL(FunctionId::SumIfs,     "SUMIFS",     3, UINT_MAX, SumIfsFunction);
+}
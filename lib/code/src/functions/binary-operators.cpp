@@ -4,6 +4,8 @@
 #include "binary-operators.h"
 #include "../execution-context.h"
 
+#include <spreader/bytecode.h>
+
 using namespace Spreader;
 
 template class Spreader::BinaryOperatorNode<ScalarAdd>;
@@ -37,6 +39,23 @@ template<> struct Spreader::OperatorSymbol<ScalarGreaterEquals>   { static const
 template<> struct Spreader::OperatorSymbol<ScalarLess>            { static constexpr char32_t value   = U'<';  };
 template<> struct Spreader::OperatorSymbol<ScalarLessEquals>      { static constexpr char32_t value[] = U"<="; };
 
+namespace Spreader {
+    template<class Op> struct OperatorOpCode;
+}
+
+template<> struct Spreader::OperatorOpCode<ScalarAdd>             { static constexpr auto value = Bytecode::OpCode::Add;            };
+template<> struct Spreader::OperatorOpCode<ScalarSubtract>        { static constexpr auto value = Bytecode::OpCode::Subtract;       };
+template<> struct Spreader::OperatorOpCode<ScalarMultiply>        { static constexpr auto value = Bytecode::OpCode::Multiply;       };
+template<> struct Spreader::OperatorOpCode<ScalarDivide>          { static constexpr auto value = Bytecode::OpCode::Divide;         };
+template<> struct Spreader::OperatorOpCode<ScalarPower>           { static constexpr auto value = Bytecode::OpCode::Power;          };
+template<> struct Spreader::OperatorOpCode<ScalarAmpersand>       { static constexpr auto value = Bytecode::OpCode::Ampersand;      };
+template<> struct Spreader::OperatorOpCode<ScalarEquals>          { static constexpr auto value = Bytecode::OpCode::Equals;         };
+template<> struct Spreader::OperatorOpCode<ScalarNotEquals>       { static constexpr auto value = Bytecode::OpCode::NotEquals;      };
+template<> struct Spreader::OperatorOpCode<ScalarGreater>         { static constexpr auto value = Bytecode::OpCode::Greater;        };
+template<> struct Spreader::OperatorOpCode<ScalarGreaterEquals>   { static constexpr auto value = Bytecode::OpCode::GreaterEquals;  };
+template<> struct Spreader::OperatorOpCode<ScalarLess>            { static constexpr auto value = Bytecode::OpCode::Less;           };
+template<> struct Spreader::OperatorOpCode<ScalarLessEquals>      { static constexpr auto value = Bytecode::OpCode::LessEquals;     };
+
 
 template<class BinaryOp>
 auto BinaryOperatorNode<BinaryOp>::createExecutionStackEntry(ExecutionMemoryResource & mem, TreeTraversalState state) const -> ExecutionStackEntryPtr {
@@ -82,6 +101,15 @@ auto BinaryOperatorNode<BinaryOp>::execute(ExecutionContext & context) const ->
     return true;
 }
 
+template<class BinaryOp>
+auto BinaryOperatorNode<BinaryOp>::compile(BytecodeBuilder & builder) const -> bool {
+    auto lhs = TraversalAccessBase::firstChild(this);
+    if (!builder.add(*lhs) || !builder.add(*TraversalAccessBase::nextSibling(lhs)))
+        return false;
+    builder.addOperator(OperatorOpCode<BinaryOp>::value);
+    return true;
+}
+
 
 template<class BinaryOp>
 void BinaryOperatorNode<BinaryOp>::reconstructAfterChild(const ReconstructionContext & /*context*/, uint16_t idx, StringBuilder & dest) const {
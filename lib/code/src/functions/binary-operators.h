@@ -28,6 +28,7 @@ namespace Spreader {
         auto createExecutionStackEntry(ExecutionMemoryResource & mem, TreeTraversalState state) const -> ExecutionStackEntryPtr override;
         auto onAfterArgument(ExecutionContext & context) const -> TraversalEventOutcome override;
         auto execute(ExecutionContext & context) const -> bool override;
+        auto compile(BytecodeBuilder & builder) const -> bool override;
         
         void reconstructAfterChild(const ReconstructionContext & context, uint16_t idx, StringBuilder & dest) const override;
     private:
@@ -4,6 +4,8 @@
 #include "true-function-creation.h"
 #include "../execution-context.h"
 
+#include <spreader/bytecode.h>
+
 namespace Spreader {
 
     class FunctionChoose : public TrueFunctionNodeBase {
@@ -88,6 +90,10 @@ namespace Spreader {
             context.returnedExtent = entry->extent;
             return true;
         }
+
+        auto compile(BytecodeBuilder & builder) const -> bool override {
+            return builder.addBranches(Bytecode::OpCode::Choose, *TraversalAccessBase::firstChild(this), childrenCount() - 1u);
+        }
     };
     
     SPR_MAP_FUNCTION_ID_TO_IMPL(FunctionId::Choose, "CHOOSE", 2, UINT_MAX, FunctionChoose);
@@ -4,6 +4,8 @@
 #include "true-function-creation.h"
 #include "../execution-context.h"
 
+#include <spreader/bytecode.h>
+
 namespace Spreader {
 
     class FunctionIf : public TrueFunctionNodeBase {
@@ -86,6 +88,10 @@ namespace Spreader {
             context.returnedExtent = entry->extent;
             return true;
         }
+
+        auto compile(BytecodeBuilder & builder) const -> bool override {
+            return builder.addBranches(Bytecode::OpCode::If, *TraversalAccessBase::firstChild(this), 2);
+        }
     };
     
     SPR_MAP_FUNCTION_ID_TO_IMPL(FunctionId::If, "IF", 3, 3, FunctionIf);
@@ -18,6 +18,7 @@ namespace Spreader {
         Average,
         AverageA,
         AverageIf,
+        AverageIfs,
         Ceil,
         Choose,
         Column,
@@ -25,6 +26,8 @@ namespace Spreader {
         Concatenate,
         Count,
         CountA,
+        CountIf,
+        CountIfs,
         Date,
         DateDif,
         Day,
@@ -84,6 +87,7 @@ namespace Spreader {
         Substitute,
         Sum,
         SumIf,
+        SumIfs,
         Switch,
         Time,
         Today,
@@ -101,6 +105,22 @@ namespace Spreader {
     };
 
     auto functionPrefixToId(const char * prefix) -> std::optional<FunctionId>;
+
+    /**
+     Whether the result of the function can change without any of the cells it references changing.
+     
+     Formulas containing such functions are recalculated on every recalculation of the sheet.
+     */
+    constexpr auto isVolatile(FunctionId id) noexcept -> bool {
+        switch(id) {
+            case FunctionId::Indirect:
+            case FunctionId::Now:
+            case FunctionId::Today:
+                return true;
+            default:
+                return false;
+        }
+    }
     
     auto createTrueFunctionNode(FormulaParser::Parser & parser, FunctionId id, ArgumentList && args) -> AstNodePtr;
     
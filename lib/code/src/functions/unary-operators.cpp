@@ -4,6 +4,8 @@
 #include "unary-operators.h"
 #include "../execution-context.h"
 
+#include <spreader/bytecode.h>
+
 using namespace Spreader;
 
 template class Spreader::UnaryOperatorNode<ScalarNegate>;
@@ -18,6 +20,14 @@ template<> struct Spreader::OperatorSymbol<ScalarNegate>  { static constexpr cha
 template<> struct Spreader::OperatorSymbol<ScalarAffirm>  { static constexpr char32_t value = U'+';  };
 template<> struct Spreader::OperatorSymbol<ScalarPercent> { static constexpr char32_t value = U'%';  };
 
+namespace Spreader {
+    template<class Op> struct OperatorOpCode;
+}
+
+template<> struct Spreader::OperatorOpCode<ScalarNegate>  { static constexpr auto value = Bytecode::OpCode::Negate;  };
+template<> struct Spreader::OperatorOpCode<ScalarAffirm>  { static constexpr auto value = Bytecode::OpCode::Affirm;  };
+template<> struct Spreader::OperatorOpCode<ScalarPercent> { static constexpr auto value = Bytecode::OpCode::Percent; };
+
 
 template<class UnaryOp>
 auto UnaryOperatorNode<UnaryOp>::createExecutionStackEntry(ExecutionMemoryResource & mem, TreeTraversalState state) const -> ExecutionStackEntryPtr {
@@ -49,6 +59,14 @@ auto UnaryOperatorNode<UnaryOp>::execute(ExecutionContext & context) const -> bo
     return true;
 }
 
+template<class UnaryOp>
+auto UnaryOperatorNode<UnaryOp>::compile(BytecodeBuilder & builder) const -> bool {
+    if (!builder.add(*TraversalAccessBase::firstChild(this)))
+        return false;
+    builder.addOperator(OperatorOpCode<UnaryOp>::value);
+    return true;
+}
+
 
 template<class UnaryOp>
 void UnaryOperatorNode<UnaryOp>::reconstructPrefix(const ReconstructionContext & /*context*/, StringBuilder & dest) const {
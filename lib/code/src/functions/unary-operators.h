@@ -27,6 +27,7 @@ namespace Spreader {
         auto createExecutionStackEntry(ExecutionMemoryResource & mem, TreeTraversalState state) const -> ExecutionStackEntryPtr override;
         auto onAfterArgument(ExecutionContext & context) const -> TraversalEventOutcome override;
         auto execute(ExecutionContext & context) const -> bool override;
+        auto compile(BytecodeBuilder & builder) const -> bool override;
         
         void reconstructPrefix(const ReconstructionContext & context, StringBuilder & dest) const override;
         void reconstructSuffix(const ReconstructionContext & context, StringBuilder & dest) const override;
@@ -0,0 +1,206 @@
+// Copyright (c) 2022, Eugene Gershnik
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <spreader/lookup-index.h>
+
+#include <algorithm>
+
+using namespace Spreader;
+
+auto LookupIndex::canFind(const Scalar & value) noexcept -> bool {
+
+    auto str = get<String>(&value);
+    if (!str)
+        return true;
+    //a string without wildcards (or escapes) only matches itself
+    String::char_access access(*str);
+    return std::none_of(access.begin(), access.end(), [](auto c) {
+        return c == '*' || c == '?' || c == '~';
+    });
+}
+
+void LookupIndex::add(SizeType idx, const Scalar & value) {
+
+    applyVisitor([&](auto && val) {
+
+        using T = std::remove_cvref_t<decltype(val)>;
+
+        //only the first occurrence of each value matters so nothing is overwritten
+        if constexpr (std::is_same_v<T, Number>) {
+            //+0 and -0 are the same key
+            m_numbers.try_emplace(val.value() + 0., idx);
+        } else if constexpr (std::is_same_v<T, String>) {
+            m_strings.try_emplace(val, idx);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            auto & first = val ? m_firstTrue : m_firstFalse;
+            if (!first)
+                first = idx;
+        } else if constexpr (std::is_same_v<T, Scalar::Blank>) {
+            if (!m_firstBlank)
+                m_firstBlank = idx;
+        }
+    }, value);
+}
+
+auto LookupIndex::find(const Scalar & value) const noexcept -> std::optional<SizeType> {
+
+    auto findNumber = [&](double number) -> std::optional<SizeType> {
+        if (auto it = m_numbers.find(number + 0.); it != m_numbers.end())
+            return it->second;
+        return std::nullopt;
+    };
+
+    return applyVisitor([&](auto && val) -> std::optional<SizeType> {
+
+        using T = std::remove_cvref_t<decltype(val)>;
+
+        if constexpr (std::is_same_v<T, Number>) {
+            auto ret = findNumber(val.value());
+            if (val.value() == 0 && m_firstBlank && (!ret || *m_firstBlank < *ret))
+                ret = m_firstBlank;
+            return ret;
+        } else if constexpr (std::is_same_v<T, String>) {
+            if (auto it = m_strings.find(val); it != m_strings.end())
+                return it->second;
+            return std::nullopt;
+        } else if constexpr (std::is_same_v<T, bool>) {
+            return val ? m_firstTrue : m_firstFalse;
+        } else if constexpr (std::is_same_v<T, Scalar::Blank>) {
+            //blank only matches 0
+            return findNumber(0.);
+        } else {
+            return std::nullopt;
+        }
+    }, value);
+}
+
+template<class T>
+void SortedLookupIndex::Sequence<T>::add(SizeType idx, const T & value) {
+
+    if (!values.empty()) {
+        const T & last = values.back();
+        auto ordering = last <=> value;
+        ascending = ascending && ordering <= 0;
+        descending = descending && ordering >= 0;
+    }
+    positions.push_back(idx);
+    values.push_back(value);
+}
+
+template<class T>
+auto SortedLookupIndex::Sequence<T>::findNotGreater(const T & value) const noexcept -> std::optional<SizeType> {
+
+    SPR_ASSERT_LOGIC(ascending);
+    auto it = std::upper_bound(values.begin(), values.end(), value);
+    if (it == values.begin())
+        return std::nullopt;
+    return positions[size_t(it - values.begin()) - 1];
+}
+
+template<class T>
+auto SortedLookupIndex::Sequence<T>::findNotLess(const T & value) const noexcept -> std::optional<SizeType> {
+
+    SPR_ASSERT_LOGIC(descending);
+    auto it = std::partition_point(values.begin(), values.end(), [&](const T & val) {
+        return val > value;
+    });
+    auto pos = size_t(it - values.begin());
+    if (it != values.end() && *it == value)
+        return positions[pos];
+    if (pos == 0)
+        return std::nullopt;
+    return positions[pos - 1];
+}
+
+auto SortedLookupIndex::canFind(const Scalar & value) noexcept -> bool {
+    return get<Number>(&value) || get<String>(&value) || get<bool>(&value);
+}
+
+void SortedLookupIndex::add(SizeType idx, const Scalar & value) {
+
+    applyVisitor([&](auto && val) {
+
+        using T = std::remove_cvref_t<decltype(val)>;
+
+        if constexpr (std::is_same_v<T, Number>) {
+            m_numbers.add(idx, val.value());
+        } else if constexpr (std::is_same_v<T, String>) {
+            m_strings.add(idx, val);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            m_booleans.add(idx, val);
+        } else if constexpr (std::is_same_v<T, Scalar::Blank>) {
+            m_numbers.add(idx, 0.);
+        }
+    }, value);
+}
+
+void SortedLookupIndex::addBlanks(SizeType first, SizeType last) {
+
+    m_numbers.add(first, 0.);
+    if (last != first)
+        m_numbers.add(last, 0.);
+}
+
+template<class Func>
+auto SortedLookupIndex::visitSequence(const Scalar & value, Func && func) const noexcept {
+
+    return applyVisitor([&](auto && val) -> decltype(func(m_numbers, 0.)) {
+
+        using T = std::remove_cvref_t<decltype(val)>;
+
+        if constexpr (std::is_same_v<T, Number>) {
+            return func(m_numbers, val.value());
+        } else if constexpr (std::is_same_v<T, String>) {
+            return func(m_strings, val);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            return func(m_booleans, val);
+        } else {
+            SPR_FATAL_ERROR("value cannot be looked up");
+        }
+    }, value);
+}
+
+auto SortedLookupIndex::isSorted(const Scalar & value, bool descending) const noexcept -> bool {
+
+    return visitSequence(value, [descending](const auto & sequence, const auto &) {
+        return descending ? sequence.descending : sequence.ascending;
+    });
+}
+
+auto SortedLookupIndex::findNotGreater(const Scalar & value) const noexcept -> std::optional<SizeType> {
+
+    return visitSequence(value, [](const auto & sequence, const auto & val) {
+        return sequence.findNotGreater(val);
+    });
+}
+
+auto SortedLookupIndex::findNotLess(const Scalar & value) const noexcept -> std::optional<SizeType> {
+
+    return visitSequence(value, [](const auto & sequence, const auto & val) {
+        return sequence.findNotLess(val);
+    });
+}
+
+void LookupIndexCache::add(Rect area) {
+
+    if (m_entries.size() == s_maxEntries) {
+        auto & oldest = m_entries.front();
+        m_areas.erase(oldest.area, &oldest);
+        m_entries.pop_front();
+    }
+    auto & entry = m_entries.emplace_back(Entry{area, nullptr, nullptr});
+    m_areas.insert(area, &entry);
+}
+
+void LookupIndexCache::invalidate(Rect area) {
+
+    m_areas.forEachIntersecting(area, [&](Rect, Entry * entry) {
+        entry->index = nullptr;
+        entry->sortedIndex = nullptr;
+    });
+}
+
+void LookupIndexCache::clear() noexcept {
+    m_areas.clear();
+    m_entries.clear();
+}
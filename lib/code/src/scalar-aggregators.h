@@ -8,6 +8,7 @@
 
 #include <functional>
 #include <optional>
+#include <span>
 
 namespace Spreader {
 
@@ -17,6 +18,8 @@ namespace Spreader {
         class NumericAggregator {
 
         public:
+            static constexpr bool ignoresBlanks = true;
+
             auto addDirect(const Scalar & val) noexcept -> bool {
                 return applyVisitorCoercedTo<Number>([&](const auto & val) -> bool {
 
@@ -69,6 +72,12 @@ namespace Spreader {
 
             }
 
+            ///Same as calling addIndirect() for each of the numbers
+            auto addNumbers(std::span<const double> values) noexcept -> bool {
+                m_aggregate.add(values.data(), values.size());
+                return true;
+            }
+
             auto result() const noexcept -> Scalar {
                 
                 if (m_error)
@@ -93,6 +102,8 @@ namespace Spreader {
         class NumericCounter {
 
         public:
+            static constexpr bool ignoresBlanks = true;
+
             auto addDirect(const Scalar & val) noexcept -> bool {
                 if constexpr (AllSemantics) {
                     if (!val.isBlank()) {
@@ -121,6 +132,11 @@ namespace Spreader {
                 return true;
             }
 
+            auto addNumbers(std::span<const double> values) noexcept -> bool {
+                m_count += unsigned(values.size());
+                return true;
+            }
+
             auto result() const noexcept -> Scalar {
                 return m_count;
             }
@@ -136,6 +152,9 @@ namespace Spreader {
         template<class Op>
         class BooleanAggregator {
         public:
+            //blanks are coerced to false
+            static constexpr bool ignoresBlanks = false;
+
             auto addDirect(const Scalar & val) noexcept -> bool {
                 return applyVisitor([&](const auto & val) {
 
@@ -190,6 +209,8 @@ namespace Spreader {
         
         class StringConcat {
         public:
+            static constexpr bool ignoresBlanks = true;
+
             auto addDirect(const Scalar & val) noexcept -> bool {
                 return applyVisitorCoercedTo<String>([&](auto && val) {
 
@@ -43,6 +43,12 @@ namespace Spreader {
             
             static auto lookupPoint(SizeType n, SizeType index) -> Point
                 { return makePoint(n, index); }
+
+            static auto comparisonSize(SizeType extent) -> Size
+                { return asSize(makePoint(extent, 1)); }
+
+            static auto indexOf(Point origin, Point pt) -> SizeType
+                { return dim(pt) - dim(origin); }
             
             static auto extractorOf(const ArrayPtr & array) {
                 return [&](SizeType idx) -> const Scalar & {
@@ -122,6 +128,9 @@ namespace Spreader {
 //            }
 //        };
 
+        ///Below this size scanning is cheap enough
+        static constexpr SizeType s_minIndexedExtent = 64;
+
     public:
 
         template<class Res, class T>
@@ -215,11 +224,11 @@ namespace Spreader {
         static void matchExact(const Scalar & value, const ArrayPtr & array, Dest & dest) {
 
             using Traits = DirectionTraits<Dir>;
-            Match match;
+            Match match(value);
             
             for(auto idx: DimensionRange(0, Traits::extentOf(array))) {
                 const Scalar & val = (*array)[Traits::comparisonPoint(idx)];
-                if (match(value, val)) {
+                if (match(val)) {
                     dest.template set<Dir>(array, idx);
                     return;
                 }
@@ -233,15 +242,47 @@ namespace Spreader {
             using Traits = DirectionTraits<Dir>;
             
             auto extent = Traits::extentOf(param);
-            Match match;
+
+            if (auto indices = param.context.lookupIndices(); indices && extent >= s_minIndexedExtent && LookupIndex::canFind(value)) {
+                Rect area{param.rect.origin, Traits::comparisonSize(extent)};
+                auto index = indices->get<LookupIndex>(area, [&](LookupIndex & newIndex) {
+                    return buildIndex<Dir>(param.context, area, extent, newIndex);
+                });
+                if (index) {
+                    if (auto found = index->find(value))
+                        dest.template set<Dir>(param, *found);
+                    else
+                        dest.result = Error::InvalidArgs;
+                    return;
+                }
+            }
+
+            Match match(value);
             
             bool noDependencies = true;
             SizeType found = extent;
-            for(auto idx: DimensionRange(0, extent)) {
+
+            //only existing cells are visited, the missing ones in between are blanks
+            const bool blankMatches = match(Scalar{});
+            auto matchBlank = [&](SizeType idx) {
+                if constexpr (Dest::optimizeSettingValue)
+                    dest.setFoundValue(Scalar{});
+                found = idx;
+            };
+
+            SizeType nextIdx = 0;
+            bool completed = param.context.grid().forEachCell(Rect{param.rect.origin, Traits::comparisonSize(extent)}, [&](Point pt, CellRef cell) {
+                
+                auto idx = Traits::indexOf(param.rect.origin, pt);
+                if (noDependencies && blankMatches && idx != nextIdx) {
+                    matchBlank(nextIdx);
+                    return false;
+                }
+                nextIdx = idx + 1;
+
                 bool shouldContinue = true;
-                Point pt = param.rect.origin + asSize(Traits::comparisonPoint(idx));
-                param.context.evaluateCell(pt, [&](const Scalar & val) {
-                    if (noDependencies && match(value, val)) {
+                param.context.evaluateCell(cell, [&](const Scalar & val) {
+                    if (noDependencies && match(val)) {
                         if constexpr (Dest::optimizeSettingValue)
                             dest.setFoundValue(val);
                         found = idx;
@@ -251,9 +292,10 @@ namespace Spreader {
                     noDependencies = false;
                     shouldContinue = !isCircular;
                 });
-                if (!shouldContinue)
-                    break;
-            }
+                return shouldContinue;
+            });
+            if (completed && noDependencies && blankMatches && nextIdx != extent)
+                matchBlank(nextIdx);
             if (!noDependencies)
                 dest.result = std::nullopt;
             else if (found != extent) {
@@ -269,6 +311,31 @@ namespace Spreader {
             }
         }
 
+        ///Fails if any cell needs to be recalculated first. The lookup then proceeds as usual reporting it.
+        template<Direction Dir>
+        static auto buildIndex(ExecutionContext & context, Rect area, SizeType extent, LookupIndex & index) -> bool {
+
+            using Traits = DirectionTraits<Dir>;
+
+            //only existing cells are visited, the missing ones in between are blanks
+            SizeType nextIdx = 0;
+            bool completed = context.grid().forEachCell(area, [&](Point pt, CellRef cell) {
+                
+                auto idx = Traits::indexOf(area.origin, pt);
+                if (idx != nextIdx)
+                    index.add(nextIdx, Scalar{});
+                nextIdx = idx + 1;
+                return context.peekCell(cell, [&](const Scalar & val) {
+                    index.add(idx, val);
+                });
+            });
+            if (!completed)
+                return false;
+            if (nextIdx != extent)
+                index.add(nextIdx, Scalar{});
+            return true;
+        }
+
 //        template<Direction Dir, class Comp, class Dest>
 //        static void matchInexact(const Scalar & value, const ArrayPtr & array, Dest & dest) {
 //
@@ -335,6 +402,11 @@ namespace Spreader {
         static void matchInexactForward(const Scalar & value, const Arg & arg, Dest & dest) {
             
             using Traits = DirectionTraits<Dir>;
+
+            if constexpr (std::is_same_v<Arg, RectParam>) {
+                if (matchSorted<Dir, false>(value, arg, dest))
+                    return;
+            }
             
             auto extent = Traits::extentOf(arg);
             auto range = DimensionRange{0, extent};
@@ -384,6 +456,11 @@ namespace Spreader {
         static void matchInexactBackward(const Scalar & value, const Arg & arg, Dest & dest) {
             
             using Traits = DirectionTraits<Dir>;
+
+            if constexpr (std::is_same_v<Arg, RectParam>) {
+                if (matchSorted<Dir, true>(value, arg, dest))
+                    return;
+            }
             
             auto extent = Traits::extentOf(arg);
             auto range = ReverseDimensionRange{extent, 0};
@@ -449,6 +526,51 @@ namespace Spreader {
         }
         
         
+        /**
+         Inexact lookup via a shared SortedLookupIndex. Returns false if there is none or the values are not
+         sorted in the expected order, in which case the lookup needs to bisect the cells.
+         */
+        template<Direction Dir, bool Descending, class Dest>
+        static auto matchSorted(const Scalar & value, const RectParam & param, Dest & dest) -> bool {
+
+            using Traits = DirectionTraits<Dir>;
+
+            auto extent = Traits::extentOf(param);
+            auto indices = param.context.lookupIndices();
+            if (!indices || extent < s_minIndexedExtent || !SortedLookupIndex::canFind(value))
+                return false;
+
+            Rect area{param.rect.origin, Traits::comparisonSize(extent)};
+            auto index = indices->get<SortedLookupIndex>(area, [&](SortedLookupIndex & newIndex) {
+                
+                SizeType nextIdx = 0;
+                bool completed = param.context.grid().forEachCell(area, [&](Point pt, CellRef cell) {
+                    
+                    auto idx = Traits::indexOf(area.origin, pt);
+                    if (idx != nextIdx)
+                        newIndex.addBlanks(nextIdx, idx - 1);
+                    nextIdx = idx + 1;
+                    return param.context.peekCell(cell, [&](const Scalar & val) {
+                        newIndex.add(idx, val);
+                    });
+                });
+                if (!completed)
+                    return false;
+                if (nextIdx != extent)
+                    newIndex.addBlanks(nextIdx, extent - 1);
+                return true;
+            });
+            if (!index || !index->isSorted(value, Descending))
+                return false;
+
+            auto found = Descending ? index->findNotLess(value) : index->findNotGreater(value);
+            if (found)
+                dest.template set<Dir>(param, *found);
+            else
+                dest.result = Error::InvalidArgs;
+            return true;
+        }
+        
         template<class Range>
         struct Bisector {
             
@@ -661,8 +783,16 @@ namespace Spreader {
 //        }
 
 
-        struct Match {
-            auto operator()(const Scalar & test, const Scalar & value) -> bool {
+        class Match {
+        public:
+            Match(const Scalar & test):
+                m_test(test) {
+
+                if (auto str = get<String>(&test))
+                    m_pattern.emplace(String::char_access(*str), String::storage_type('~'));
+            }
+
+            auto operator()(const Scalar & value) const -> bool {
                 
                 return applyVisitor([&](auto && lhs, auto && rhs)  {
                     
@@ -673,8 +803,7 @@ namespace Spreader {
                         //happy case: same type
                         if constexpr (std::is_same_v<LHS, String>) {
                             
-                            Wildcarder<String::storage_type, String::char_access::iterator, String::char_access::iterator> wildcarder('~');
-                            return wildcarder.match(String::char_access(lhs), String::char_access(rhs));
+                            return m_pattern->match(String::char_access(rhs));
                             
                         } else if constexpr (std::is_same_v<LHS, Number> || std::is_same_v<LHS, bool>) {
                             
@@ -696,8 +825,13 @@ namespace Spreader {
                         return false;
                     }
                     
-                }, test, value);
+                }, m_test, value);
             }
+
+        private:
+            const Scalar & m_test;
+            ///Compiled m_test if it is a string
+            std::optional<WildcardPattern<String::storage_type>> m_pattern;
         };
         
         struct Compare {
@@ -51,6 +51,12 @@ namespace Spreader {
             void handleSecond(T && arg) noexcept {
 
                 if (auto * lhs = get<Dest>(&this->result)) {
+
+                    //the common case of both operands already being of the right type needs no coercion
+                    if (auto * rhs = get<Dest>(&arg)) {
+                        this->result = Op()(*lhs, *rhs);
+                        return;
+                    }
                     
                     applyVisitorCoercedTo<Dest>([&](auto && val)  {
                         
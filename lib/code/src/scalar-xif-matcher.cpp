@@ -76,6 +76,7 @@ void XIfMatcher::parseMatchString(const String & str) {
         case 3: m_op = Greater(); break;
         case 4: m_op = GreaterEqual(); break;
         case 5: break; //m_op = EqualTo(); break; - this is the default init
+        case MiniTrie<Char>::noMatch: break; //no operator means equality too
         default: SPR_ASSERT_LOGIC(false);
     }
     
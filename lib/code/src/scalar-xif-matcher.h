@@ -9,6 +9,11 @@
 #include "wildcarder.h"
 #include "number-matcher.h"
 
+#include <algorithm>
+#include <compare>
+#include <optional>
+#include <vector>
+
 namespace Spreader {
 
     class XIfMatcher {
@@ -29,9 +34,14 @@ namespace Spreader {
             auto operator()(const XIfMatcher &, const T & comp, const T & val) const noexcept -> bool
                 { return comp == val; }
             
-            auto operator()(const XIfMatcher & owner, const String & comp, const String & val) const noexcept -> bool {
-                auto upperText = val.to_upper();
-                return owner.m_wildcarder.match(String::char_access(comp), String::char_access(upperText));
+            auto operator()(const XIfMatcher & owner, const String &, const String & val) const noexcept -> bool {
+                if (!owner.foldAscii(val)) {
+                    auto upperText = val.to_upper();
+                    String::char_access access(upperText);
+                    owner.m_folded.assign(access.begin(), access.end());
+                }
+                const CharType * folded = owner.m_folded.data();
+                return owner.m_pattern->match(folded, folded + owner.m_folded.size());
             }
             
             auto operator()(const XIfMatcher &, Scalar::Blank, const String & val) const noexcept -> bool {
@@ -68,8 +78,19 @@ namespace Spreader {
             auto operator()(const XIfMatcher &, bool comp, bool val) const noexcept -> bool
                 { return Rel()(val, comp); }
             
-            auto operator()(const XIfMatcher &, const String & comp, const String & val) const noexcept -> bool {
-                return Rel()(val.to_upper(), comp);
+            auto operator()(const XIfMatcher & owner, const String & comp, const String & val) const noexcept -> bool {
+                if (!owner.foldAscii(val))
+                    return Rel()(val.to_upper(), comp);
+                
+                //ASCII code units compare the same as code points against anything 
+                String::char_access access(comp);
+                auto res = std::lexicographical_compare_three_way(owner.m_folded.begin(), owner.m_folded.end(),
+                                                                  access.begin(), access.end(), 
+                                                                  [](CharType lhs, CharType rhs) {
+                    using Unit = std::make_unsigned_t<CharType>;
+                    return Unit(lhs) <=> Unit(rhs);
+                });
+                return Rel()((res > 0) - (res < 0), 0);
             }
         };
         
@@ -81,8 +102,7 @@ namespace Spreader {
     public:
         template<class T>
         requires(std::is_same_v<std::remove_cvref_t<T>, Scalar>)
-        XIfMatcher(T && cond):
-            m_wildcarder(CharType('~')) {
+        XIfMatcher(T && cond) {
 
             applyVisitor([&](auto && val) {
 
@@ -98,6 +118,9 @@ namespace Spreader {
                 }
 
             }, std::forward<T>(cond));
+
+            if (auto str = get<String>(&m_compValue))
+                m_pattern.emplace(String::char_access(*str), CharType('~'));
         }
         
         template<class T>
@@ -124,13 +147,38 @@ namespace Spreader {
             return (*this)(Scalar(std::forward<T>(arg)));
         }
 
+        ///Whether the criterion is a string. Matching it is considerably slower than any other criterion.
+        auto hasStringCriterion() const noexcept -> bool {
+            return bool(m_pattern);
+        }
+
     private:
         void parseMatchString(const String & str);
 
+        /**
+         Upper-cases an ASCII-only string into m_folded. Returns false for any other string.
+         
+         Upper case of ASCII is ASCII so this avoids allocating a new string for each compared value 
+         in the common case. 
+         */
+        auto foldAscii(const String & str) const noexcept -> bool {
+            String::char_access access(str);
+            m_folded.clear();
+            for (CharType c: access) {
+                if (std::make_unsigned_t<CharType>(c) >= 0x80)
+                    return false;
+                m_folded.push_back(c >= CharType('a') && c <= CharType('z') ? CharType(c - ('a' - 'A')) : c);
+            }
+            return true;
+        }
+
     private:
         Scalar m_compValue;
         std::variant<EqualTo, NotEqualTo, Less, LessEqual, Greater, GreaterEqual> m_op;
-        mutable Wildcarder<CharType, String::char_access::iterator, String::char_access::iterator> m_wildcarder;
+        ///Compiled m_compValue if it is a string
+        std::optional<WildcardPattern<CharType>> m_pattern;
+        ///Upper-cased value being compared
+        mutable std::vector<CharType> m_folded;
     };
 }
 
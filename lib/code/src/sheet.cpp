@@ -2,15 +2,37 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
 #include <spreader/sheet.h>
-//#include <spreader/mru-cache.h>
 
 #include "formula-evaluator.h"
 
+#include <deque>
 #include <list>
 #include <map>
 
+#if !SPR_SINGLE_THREADED
+    #include <atomic>
+    #include <mutex>
+    #include <thread>
+#endif
+
 using namespace Spreader;
 
+struct Sheet::PendingEvaluation {
+    PendingEvaluation(FormulaCell * formulaCell_): formulaCell(formulaCell_)
+    {}
+
+    FormulaCell * formulaCell;
+    std::optional<FormulaEvaluator> evaluator;
+};
+
+//Destroys paused evaluators in reverse order of their creation
+struct Sheet::PendingEvaluations : std::deque<PendingEvaluation> {
+    ~PendingEvaluations() {
+        while(!this->empty())
+            this->pop_back();
+    }
+};
+
 struct Sheet::ReplaceOldExtensionCell {
 
     #ifdef NDEBUG
@@ -34,8 +56,7 @@ struct Sheet::ReserveNewExtensionCell {
     SPR_ALWAYS_INLINE auto operator()(CellPtr & cell) -> int {
 
         SPR_ASSERT_LOGIC(!cell ||
-                            (cell->getType() == CellType::Value &&
-                            static_cast<ValueCell *>(cell.get())->isBlank()));
+                            (cell.getType() == CellType::Value && cell.value().isBlank()));
         
         int ret = -int(bool(cell));
         cell = FormulaCellExtension::create(formulaCell, Scalar::Blank{});
@@ -53,7 +74,7 @@ struct Sheet::ClearExtensionCell {
 
     auto operator()(CellPtr & cell) noexcept -> int {
         
-        SPR_ASSERT_LOGIC(cell && cell->getType() == CellType::FormulaExtension);
+        SPR_ASSERT_LOGIC(cell && cell.getType() == CellType::FormulaExtension);
         int ret = -int(bool(cell));
         cell = nullptr;
         return ret;
@@ -63,60 +84,102 @@ struct Sheet::ClearExtensionCell {
 
 void Sheet::recalculate() {
 
-    m_evalGeneration = !m_evalGeneration;
+    if (m_grid.size() != m_calculatedSize) {
+        m_dependencies.forEachSizeDependent([this](FormulaCell * formulaCell) {
+            markStale(formulaCell);
+        });
+        m_calculatedSize = m_grid.size();
+    }
+    m_dependencies.forEachVolatile([this](FormulaCell * formulaCell) {
+        markStale(formulaCell);
+    });
 
     AstNode::ExecutionMemoryResource memory;
+    //Cells waiting for their dependencies, innermost dependency last. Paused evaluators are kept 
+    //so that evaluation can resume where it stopped. They all allocate from the same stack memory 
+    //so must be destroyed in reverse order of creation which the nesting of dependencies guarantees.
+    PendingEvaluations pending;
+#if !SPR_SINGLE_THREADED
+    unsigned threadCount = m_recalcThreadCount ? m_recalcThreadCount : std::thread::hardware_concurrency();
+    bool tryConcurrently = (threadCount > 1);
+#endif
+    size_t pausedCount = 0;
+
+    for ( ; ; ) {
+
+        markDependentsStale();
+
+        while(!pending.empty() && !pending.back().formulaCell->needsRecalc(m_evalGeneration)) {
+            SPR_ASSERT_LOGIC(!pending.back().evaluator);
+            pending.pop_back();
+        }
 
-    //using EvaluatorCache = MRUCache<FormulaCell *, FormulaEvaluator>;
-    //EvaluatorCache cachedEvaluators(EvaluatorCache::MaxItemCount, 1024);
-    for(auto formulaCellIt = m_formulaCells.begin(), formulaCellEnd = m_formulaCells.end(); formulaCellIt != formulaCellEnd; ) {
-
-        auto formulaCell = &*formulaCellIt;
-        
-        if (!formulaCell->needsRecalc(m_evalGeneration)) {
-            ++formulaCellIt;
+    #if !SPR_SINGLE_THREADED
+        if (tryConcurrently && pending.empty() && m_staleFormulaCells.size() >= s_minConcurrentRecalcCount) {
+            tryConcurrently = evaluateConcurrently(threadCount);
             continue;
         }
-        
-        
-//        auto evaluatorIt = cachedEvaluators.emplace(formulaCell,
-//                                                    memory,
-//                                                    m_grid,
-//                                                    formulaCell->formula(),
-//                                                    formulaCell->references(),
-//                                                    formulaCell->location(),
-//                                                    m_evalGeneration).first;
+    #endif
 
+        if (pending.empty()) {
+            if (m_staleFormulaCells.empty())
+                break;
+            pending.emplace_back(*m_staleFormulaCells.begin());
+        }
+
+        auto & current = pending.back();
+        auto formulaCell = current.formulaCell;
+
+        if (current.evaluator) {
+            --pausedCount;
+            //something it has already read may have changed while it was paused
+            if (formulaCell->inputsChanged())
+                current.evaluator.reset();
+        }
+        if (!current.evaluator) {
+            formulaCell->setBeingCalculated(true);
+            current.evaluator.emplace(memory,
+                                      m_grid,
+                                      m_nameManager,
+                                      formulaCell->formula(),
+                                      formulaCell->references(),
+                                      formulaCell->location(),
+                                      m_evalGeneration);
+            current.evaluator->setLookupIndices(&m_lookupIndices);
+        }
+        auto & evaluator = *current.evaluator;
         
-        formulaCell->setBeingCalculated(true);
-        
-        //auto & evaluator = evaluatorIt->second;
-        auto evaluator = FormulaEvaluator(memory,
-                                          m_grid,
-                                          m_nameManager,
-                                          formulaCell->formula(),
-                                          formulaCell->references(),
-                                          formulaCell->location(),
-                                          m_evalGeneration);
-        
+        //std::deque::emplace_back does not invalidate references to existing elements
         ExecutionContext::InvocableHandler handler([&](FormulaCell * dependency) {
-            m_formulaCells.erase(*dependency);
-            formulaCellIt = m_formulaCells.insert(formulaCellIt, *dependency);
+            SPR_ASSERT_LOGIC(dependency->needsRecalc(m_evalGeneration));
+            pending.emplace_back(dependency);
         });
 
         evaluator.setDependencyHandler(&handler);
         
         if (evaluate(formulaCell, evaluator)) {
+            SPR_ASSERT_LOGIC(&pending.back() == &current);
+            m_staleFormulaCells.erase(formulaCell);
             formulaCell->finishCalculation(m_evalGeneration, evaluator.isCircularDependency());
-            //cachedEvaluators.erase(evaluatorIt);
-        } /*else {
+            m_recalculatedFormulaCells.insert(formulaCell);
+            pending.pop_back();
+        } else {
             evaluator.setDependencyHandler(nullptr);
-        }*/
-        if (&*formulaCellIt == formulaCell)
-            ++formulaCellIt;
+            //Keeping too many paused evaluators around is not worth the memory. It is always safe to 
+            //discard the last one created.
+            if (pausedCount < s_maxPausedEvaluators)
+                ++pausedCount;
+            else
+                current.evaluator.reset();
+        }
     }
 
-    //SPR_ASSERT_LOGIC(cachedEvaluators.empty());
+    m_recalculatedFormulaCells.clear();
+    for(auto formulaCell: m_deferredFormulaCells)
+        markStale(formulaCell);
+    m_deferredFormulaCells.clear();
+
+    purgeStringPoolIfNeeded();
 }
 
 auto Sheet::evaluate(FormulaCell * formulaCell, FormulaEvaluator & evaluator) -> bool {
@@ -132,8 +195,12 @@ auto Sheet::evaluate(FormulaCell * formulaCell, FormulaEvaluator & evaluator) ->
             return true;
         }
         
+        poolString(evaluator.result());
         if (auto offset = evaluator.offset(); offset == Point{0, 0}) {
             reserveExtent(formulaCell, evaluator.extent());
+            //a formula whose spill area is occupied has no way to learn when it becomes free
+            auto error = get<Error>(&evaluator.result());
+            m_dependencies.setVolatile(formulaCell, formulaCell->formula()->isVolatile() || (error && *error == Error::Spill));
             formulaCell->setValue(std::move(evaluator.result()));
         } else {
             m_grid.modifyCell(formulaCell->location() + asSize(offset), ReplaceOldExtensionCell{std::move(evaluator.result())});
@@ -143,6 +210,97 @@ auto Sheet::evaluate(FormulaCell * formulaCell, FormulaEvaluator & evaluator) ->
     return true;
 }
 
+#if !SPR_SINGLE_THREADED
+
+auto Sheet::evaluateConcurrently(unsigned threadCount) -> bool {
+
+    std::vector<FormulaCell *> batch(m_staleFormulaCells.begin(), m_staleFormulaCells.end());
+    std::vector<std::optional<Scalar>> results(batch.size());
+
+    //Nothing is modified while the batch is being evaluated, so the only formulas that can be calculated
+    //are the ones that do not depend on any stale one. Anything else (as well as anything that would 
+    //need to touch cells other than its own) is abandoned and left to the sequential recalc.
+    auto tryEvaluate = [this](AstNode::ExecutionMemoryResource & memory, FormulaCell * formulaCell) -> std::optional<Scalar> {
+        
+        if (formulaCell->extent() != Size{1, 1})
+            return std::nullopt;
+
+        auto evaluator = FormulaEvaluator(memory,
+                                          m_grid,
+                                          m_nameManager,
+                                          formulaCell->formula(),
+                                          formulaCell->references(),
+                                          formulaCell->location(),
+                                          m_evalGeneration);
+        evaluator.setLookupIndices(&m_lookupIndices);
+        bool hasDependencies = false;
+        ExecutionContext::InvocableHandler handler([&](FormulaCell *) {
+            hasDependencies = true;
+        });
+        evaluator.setDependencyHandler(&handler);
+
+        if (!evaluator.eval() || hasDependencies || evaluator.isCircularDependency() || evaluator.extent() != Size{1, 1})
+            return std::nullopt;
+        if (auto error = get<Error>(&evaluator.result()); error && *error == Error::Spill)
+            return std::nullopt;
+        return std::move(evaluator.result());
+    };
+
+    std::atomic<size_t> nextIndex = 0;
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto work = [&]() {
+        try {
+            AstNode::ExecutionMemoryResource memory;
+            for ( ; ; ) {
+                size_t start = nextIndex.fetch_add(s_concurrentRecalcChunk, std::memory_order_relaxed);
+                if (start >= batch.size())
+                    break;
+                size_t end = std::min(start + s_concurrentRecalcChunk, batch.size());
+                for (size_t i = start; i < end; ++i)
+                    results[i] = tryEvaluate(memory, batch[i]);
+            }
+        } catch (...) {
+            nextIndex.store(batch.size(), std::memory_order_relaxed);
+            auto lock = std::lock_guard(errorMutex);
+            if (!error)
+                error = std::current_exception();
+        }
+    };
+
+    threadCount = unsigned(std::min(size_t(threadCount), batch.size() / s_concurrentRecalcChunk));
+    {
+        std::vector<std::jthread> helpers;
+        helpers.reserve(threadCount - 1);
+        for (unsigned i = 1; i < threadCount; ++i)
+            helpers.emplace_back(work);
+        work();
+    }
+    if (error)
+        std::rethrow_exception(error);
+
+    size_t completedCount = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        auto & result = results[i];
+        if (!result)
+            continue;
+        auto formulaCell = batch[i];
+        m_dependencies.setVolatile(formulaCell, formulaCell->formula()->isVolatile());
+        poolString(*result);
+        formulaCell->setValue(std::move(*result));
+        m_staleFormulaCells.erase(formulaCell);
+        formulaCell->finishCalculation(m_evalGeneration, false);
+        m_recalculatedFormulaCells.insert(formulaCell);
+        ++completedCount;
+    }
+
+    //Each round completes one "level" of the dependency graph. Once levels become narrow (e.g. long chains)
+    //failed attempts cost more than parallelism gains.
+    return completedCount * 4 >= batch.size();
+}
+
+#endif
+
 void Sheet::reserveExtent(FormulaCell * formulaCell, Size newExtent) {
 
     const Point at = formulaCell->location();
@@ -151,6 +309,7 @@ void Sheet::reserveExtent(FormulaCell * formulaCell, Size newExtent) {
         return;
     
     formulaCell->setExtent(newExtent);
+    markChanged(Rect{at, Size{std::max(oldExtent.width, newExtent.width), std::max(oldExtent.height, newExtent.height)}});
     
     auto commonHeight = std::min(newExtent.height, oldExtent.height);
     auto commonWidth = std::min(newExtent.width, oldExtent.width);
@@ -190,8 +349,122 @@ void Sheet::removeFormulaDependents(FormulaCell * formulaCell) {
     m_grid.modifyCells({.origin= at + Size{1, 0}, .size = {extent.width - 1, 1}}, ClearExtensionCell{});
     m_grid.modifyCells({.origin= at + Size{0, 1}, .size = {extent.width, extent.height - 1}}, ClearExtensionCell{});
     formulaCell->setExtent(Size{1, 1});
+    markChanged(Rect{at, extent});
 }
 
+void Sheet::addFormulaCell(FormulaCell * formulaCell) {
+    enlistFormulaCell(formulaCell);
+    m_dependencies.add(formulaCell);
+    markChanged(formulaCell->location());
+}
+
+void Sheet::enlistFormulaCell(FormulaCell * formulaCell) {
+    formulaCell->setOrder(++m_lastFormulaOrder);
+    formulaCell->setNeedsRecalc(m_evalGeneration);
+    m_formulaCells.push_back(*formulaCell);
+    m_staleFormulaCells.insert(m_staleFormulaCells.end(), formulaCell);
+}
+
+void Sheet::eraseFormulaCell(FormulaCell * formulaCell) {
+    m_formulaCells.erase(*formulaCell);
+    m_staleFormulaCells.erase(formulaCell);
+    m_dependencies.remove(formulaCell);
+}
+
+void Sheet::markStale(FormulaCell * formulaCell) {
+    if (formulaCell->needsRecalc(m_evalGeneration)) {
+        //a paused calculation might have already read the changed cells
+        if (formulaCell->isBeingCalculated())
+            formulaCell->setInputsChanged();
+        return;
+    }
+    //A cell made stale after being calculated in this pass is affected by its own result or by a later
+    //cell. Evaluating it again could go on forever so leave it to the next pass.
+    if (m_recalculatedFormulaCells.contains(formulaCell)) {
+        m_deferredFormulaCells.push_back(formulaCell);
+        return;
+    }
+    formulaCell->setNeedsRecalc(m_evalGeneration);
+    m_staleFormulaCells.insert(formulaCell);
+    markChanged(Rect{formulaCell->location(), formulaCell->extent()});
+}
+
+void Sheet::markAllStale() {
+    //No need to record changed areas here - everything is going to be recalculated anyway
+    m_lookupIndices.clear();
+    for(auto & formulaCell: m_formulaCells) {
+        formulaCell.setNeedsRecalc(m_evalGeneration);
+        m_staleFormulaCells.insert(&formulaCell);
+    }
+}
+
+void Sheet::reindexFormulaCells() {
+    m_dependencies.clear();
+    for(auto & formulaCell: m_formulaCells)
+        m_dependencies.add(&formulaCell);
+}
+
+void Sheet::markChanged(Rect area) {
+    area.size.width = std::min(area.size.width, maxSize().width - area.origin.x);
+    area.size.height = std::min(area.size.height, maxSize().height - area.origin.y);
+    m_changedAreas.push_back(area);
+    m_lookupIndices.invalidate(area);
+}
+
+void Sheet::markDependentsStale() {
+    while(!m_changedAreas.empty()) {
+        auto area = m_changedAreas.back();
+        m_changedAreas.pop_back();
+        m_dependencies.forEachDependent(area, [this](FormulaCell * dependent) {
+            markStale(dependent);
+        });
+    }
+}
+
+
+void Sheet::getValues(Rect rect, std::span<double> numbers, std::span<ValueType> types, std::vector<String> & strings) const {
+
+    const size_t count = size_t(rect.size.width) * rect.size.height;
+    SPR_ASSERT_INPUT(numbers.size() == count && types.size() == count);
+
+    std::fill(numbers.begin(), numbers.end(), 0.);
+    std::fill(types.begin(), types.end(), ValueType::Blank);
+    if (count == 0)
+        return;
+
+    SPR_ASSERT_INPUT(rect.origin.x < maxSize().width && rect.origin.y < maxSize().height);
+
+    m_grid.forEachCell(rect, [&](Point pt, CellRef cell) {
+
+        const size_t idx = size_t(rect.size.width) * (pt.y - rect.origin.y) + (pt.x - rect.origin.x);
+        if (cell.isInlineNumber()) {
+            numbers[idx] = cell.inlineNumber();
+            types[idx] = ValueType::Number;
+            return;
+        }
+        cell.withValue([&](const Scalar & value) {
+            applyVisitor([&](const auto & val) {
+
+                using T = std::remove_cvref_t<decltype(val)>;
+
+                if constexpr (std::is_same_v<T, bool>) {
+                    numbers[idx] = val;
+                    types[idx] = ValueType::Bool;
+                } else if constexpr (std::is_same_v<T, Number>) {
+                    numbers[idx] = val.value();
+                    types[idx] = ValueType::Number;
+                } else if constexpr (std::is_same_v<T, String>) {
+                    numbers[idx] = double(strings.size());
+                    types[idx] = ValueType::String;
+                    strings.push_back(val);
+                } else if constexpr (std::is_same_v<T, Error>) {
+                    numbers[idx] = double(val);
+                    types[idx] = ValueType::Error;
+                }
+            }, value);
+        });
+    });
+}
 
 struct Sheet::SetBlankCell {
     constexpr auto modifiesMissing() noexcept -> bool { return false; }
@@ -206,7 +479,7 @@ struct Sheet::SetBlankCell {
                 return 0;
             } else {
                 if constexpr (std::is_same_v<T, FormulaCell>) {
-                    me->m_formulaCells.erase(*ptr);
+                    me->eraseFormulaCell(ptr);
                     me->removeFormulaDependents(ptr);
                 } 
 
@@ -229,16 +502,21 @@ struct Sheet::SetValueCell {
             using T = std::remove_cv_t<std::remove_pointer_t<decltype(ptr)>>;
 
             if constexpr (std::is_same_v<T, ValueCell>) {
-                ptr->setValue(value);
+                //only strings need a ValueCell
+                if (auto ref = CellRef::inlineFor(value))
+                    cell.reset(*ref);
+                else
+                    ptr->setValue(value);
                 return 0;
             } else {
                 if constexpr (std::is_same_v<T, FormulaCell>) {
-                    me->m_formulaCells.erase(*ptr);
+                    me->eraseFormulaCell(ptr);
                     me->removeFormulaDependents(ptr);
                 } else if constexpr (std::is_same_v<T, FormulaCellExtension>) {
                     me->removeFormulaDependents(ptr->parent());
+                    me->markStale(ptr->parent());
                 } 
-                cell = ValueCell::create(value);
+                cell = CellPtr::fromValue(value);
                 return -int(!std::is_same_v<T, std::nullptr_t>) + 1;
             }
         });
@@ -259,14 +537,17 @@ struct Sheet::SetFormulaCell {
 
             if constexpr (std::is_same_v<T, FormulaCell>) {
                 ptr->replaceFormula(std::move(code), std::move(references));
+                me->m_dependencies.add(ptr);
+                me->markStale(ptr);
                 return 0;
             } else {
                 if constexpr (std::is_same_v<T, FormulaCellExtension>) {
                     me->removeFormulaDependents(ptr->parent());
+                    me->markStale(ptr->parent());
                 }
 
                 auto newCell = FormulaCell::create(std::move(code), std::move(references), coord, me->m_evalGeneration);
-                me->m_formulaCells.push_back(*newCell);
+                me->addFormulaCell(newCell.get());
                 cell = std::move(newCell);
                 return -int(!std::is_same_v<T, std::nullptr_t>) + 1;
             }
@@ -275,28 +556,101 @@ struct Sheet::SetFormulaCell {
 
     Sheet * me;
     Point coord;
-    FormulaPtr & code;
-    FormulaReferencesPtr & references;
+    ConstFormulaPtr & code;
+    ConstFormulaReferencesPtr & references;
 };
 
 
 void Sheet::setValueCell(Point coord, const Scalar & value) {
     if (get<Scalar::Blank>(&value)) {
         m_grid.modifyCell(coord, SetBlankCell{this});
+    } else if (auto str = get<String>(&value); str && m_stringPool) {
+        m_grid.modifyCell(coord, SetValueCell{this, m_stringPool->intern(*str)});
     } else {
         m_grid.modifyCell(coord, SetValueCell{this, value});
     }
+    markChanged(coord);
     recalcIfNotSuspended();
+    purgeStringPoolIfNeeded();
+}
+
+template<class T>
+struct Sheet::SetValueCells {
+    constexpr auto modifiesMissing() noexcept -> bool { return true; }
+
+    auto operator()(CellPtr & cell, Point pt) -> int {
+
+        const T & source = values[size_t(rect.size.width) * (pt.y - rect.origin.y) + (pt.x - rect.origin.x)];
+        if constexpr (std::is_same_v<T, Scalar>) {
+            if (source.isBlank())
+                return SetBlankCell{me}(cell);
+            if (auto str = get<String>(&source); str && me->m_stringPool)
+                return SetValueCell{me, me->m_stringPool->intern(*str)}(cell);
+            return SetValueCell{me, source}(cell);
+        } else if constexpr (std::is_same_v<T, String>) {
+            if (me->m_stringPool)
+                return SetValueCell{me, me->m_stringPool->intern(source)}(cell);
+            return SetValueCell{me, source}(cell);
+        } else {
+            return SetValueCell{me, Scalar(source)}(cell);
+        }
+    }
+
+    Sheet * me;
+    Rect rect;
+    const T * values;
+};
+
+template<class T>
+void Sheet::setValueCellsFrom(Rect rect, std::span<const T> values) {
+
+    SPR_ASSERT_INPUT(values.size() == size_t(rect.size.width) * rect.size.height);
+
+    m_grid.modifyCells(rect, SetValueCells<T>{this, rect, values.data()});
+    markChanged(rect);
+    recalcIfNotSuspended();
+    purgeStringPoolIfNeeded();
+}
+
+void Sheet::setValueCells(Rect rect, std::span<const Scalar> values) {
+    setValueCellsFrom(rect, values);
+}
+
+void Sheet::setValueCells(Rect rect, std::span<const double> values) {
+    setValueCellsFrom(rect, values);
+}
+
+void Sheet::setValueCells(Rect rect, std::span<const String> values) {
+    setValueCellsFrom(rect, values);
+}
+
+void Sheet::setStringPooling(bool enable) {
+    if (!enable)
+        m_stringPool.reset();
+    else if (!m_stringPool)
+        m_stringPool = std::make_unique<StringPool>();
+}
+
+void Sheet::purgeStringPoolIfNeeded() {
+    if (!m_stringPool || !m_stringPool->needsPurge())
+        return;
+    m_stringPool->purge([this](auto && report) {
+        forEachCell(Rect{Point{0, 0}, m_grid.size()}, [&](Point, const Scalar & value, bool) {
+            if (auto str = get<String>(&value))
+                report(*str);
+        });
+    });
 }
 
 void Sheet::clearCell(Point coord) {
     m_grid.modifyCell(coord, SetBlankCell{this});
+    markChanged(coord);
     recalcIfNotSuspended();
 }
 
 void Sheet::setFormulaCell(Point coord, const String & formula) {
 
-    auto [code, references] = Formula::parse(formula, coord);
+    auto [code, references] = m_formulaCache.parse(formula, coord);
     m_grid.modifyCell(coord, SetFormulaCell{this, coord, code, references});
     recalcIfNotSuspended();
 }
@@ -315,11 +669,19 @@ struct Sheet::CopyCell {
 
             using T = std::remove_cv_t<std::remove_pointer_t<decltype(ptr)>>;
 
-            if constexpr (std::is_same_v<T, ValueCell>) {
+            if constexpr (std::is_same_v<T, ValueCell> || std::is_same_v<T, InlineValueCell>) {
                 copiedCell = ptr->copy();
             } else if constexpr (std::is_same_v<T, FormulaCell>) {
                 copiedCell = ptr->copy(destination);
-                me->m_formulaCells.push_back(static_cast<FormulaCell &>(*copiedCell));
+                auto copied = static_cast<FormulaCell *>(copiedCell.get());
+                if (group) {
+                    //the whole group is indexed and marked changed once it is in place
+                    me->enlistFormulaCell(copied);
+                    group->cells[group->area.size.width * size_t(destination.y - group->area.origin.y) + 
+                                 (destination.x - group->area.origin.x)] = copied;
+                } else {
+                    me->addFormulaCell(copied);
+                }
             }
         });
         return 0;
@@ -331,13 +693,14 @@ struct Sheet::CopyCell {
             using T = std::remove_cv_t<std::remove_pointer_t<decltype(ptr)>>;
 
             if constexpr (std::is_same_v<T, FormulaCell>) {
-                me->m_formulaCells.erase(*ptr);
+                me->eraseFormulaCell(ptr);
                 //this is safe because extension cells are ignored when reading
                 me->removeFormulaDependents(ptr);
             } else if constexpr (std::is_same_v<T, FormulaCellExtension>) {
                 if (!copiedCell)
                     return 0;
                 me->removeFormulaDependents(ptr->parent());
+                me->markStale(ptr->parent());
             }
 
             int ret = -int(bool(cell)) + int(bool(copiedCell));
@@ -346,7 +709,13 @@ struct Sheet::CopyCell {
         });
     }
 
+    struct Group {
+        Rect area;
+        std::vector<FormulaCell *> cells;
+    };
+
     Sheet * me;
+    Group * group = nullptr;
     CellPtr copiedCell{}; 
     Point destination{};
 };
@@ -354,13 +723,90 @@ struct Sheet::CopyCell {
 
 void Sheet::copyCell(Point from, Rect to) {
 
-    m_grid.transformCell(from, to, CopyCell{this});
+    //A formula filled over an area keeps the same references everywhere unless some of them
+    //become invalid. If so, the copies can be indexed together as one group.
+    std::optional<CopyCell::Group> group;
+    if (uint64_t(to.size.width) * to.size.height >= s_minFormulaGroupSize) {
+        applyToCell(m_grid.getCell(from), [&](auto ptr) {
+            using T = std::remove_cv_t<std::remove_pointer_t<decltype(ptr)>>;
+
+            if constexpr (std::is_same_v<T, FormulaCell>) {
+                if (auto & refs = ptr->references(); refs && refs->isCopyableTo(to))
+                    group.emplace(to, std::vector<FormulaCell *>(size_t(to.size.width) * to.size.height));
+            }
+        });
+    }
+
+    m_grid.transformCell(from, to, CopyCell{this, group ? &*group : nullptr});
+    if (group)
+        m_dependencies.addGroup(to, std::move(group->cells));
+    markChanged(to);
     recalcIfNotSuspended();
 }
 
 void Sheet::copyCells(Rect from, Point to) {
 
     m_grid.transformCells(from, to, CopyCell{this});
+    markChanged(Rect{to, from.size});
+    recalcIfNotSuspended();
+}
+
+struct Sheet::FillFormulaCell {
+    constexpr auto modifiesMissing() noexcept -> bool { return true; }
+
+    auto operator()(CellPtr & cell, Point coord) -> int {
+
+        auto refs = (references && !sharedReferences) ? references->adjustToCopy(coord) : references;
+        auto newCell = FormulaCell::create(ConstFormulaPtr(code), std::move(refs), coord, me->m_evalGeneration);
+        if (group) {
+            //the whole group is indexed and marked changed once it is in place
+            me->enlistFormulaCell(newCell.get());
+            group->cells[group->area.size.width * size_t(coord.y - group->area.origin.y) + 
+                         (coord.x - group->area.origin.x)] = newCell.get();
+        } else {
+            me->addFormulaCell(newCell.get());
+        }
+        
+        return applyToCell(cell, [this, &cell, &newCell](auto ptr) {
+
+            using T = std::remove_cv_t<std::remove_pointer_t<decltype(ptr)>>;
+
+            if constexpr (std::is_same_v<T, FormulaCell>) {
+                me->eraseFormulaCell(ptr);
+                me->removeFormulaDependents(ptr);
+            } else if constexpr (std::is_same_v<T, FormulaCellExtension>) {
+                me->removeFormulaDependents(ptr->parent());
+                me->markStale(ptr->parent());
+            }
+
+            int ret = -int(!std::is_same_v<T, std::nullptr_t>) + 1;
+            cell = std::move(newCell);
+            return ret;
+        });
+    }
+
+    Sheet * me;
+    const ConstFormulaPtr & code;
+    const ConstFormulaReferencesPtr & references;
+    bool sharedReferences;
+    CopyCell::Group * group;
+};
+
+void Sheet::fillFormula(Rect rect, const String & formula, Point anchor) {
+
+    auto [code, references] = m_formulaCache.parse(formula, anchor);
+
+    //Same as in copyCell(): if the references stay valid everywhere all the cells can share them
+    //and be indexed together
+    const bool sharedReferences = !references || references->isCopyableTo(rect);
+    std::optional<CopyCell::Group> group;
+    if (references && sharedReferences && uint64_t(rect.size.width) * rect.size.height >= s_minFormulaGroupSize)
+        group.emplace(rect, std::vector<FormulaCell *>(size_t(rect.size.width) * rect.size.height));
+
+    m_grid.modifyCells(rect, FillFormulaCell{this, code, references, sharedReferences, group ? &*group : nullptr});
+    if (group)
+        m_dependencies.addGroup(rect, std::move(group->cells));
+    markChanged(rect);
     recalcIfNotSuspended();
 }
 
@@ -383,9 +829,13 @@ struct Sheet::MoveCell {
                 return 0;
             } else {
                 if constexpr (std::is_same_v<T, FormulaCell>) {
+                    //grouped formulas are found by location so must be unregistered before it changes
+                    me->m_dependencies.remove(ptr);
                     ptr->move(destination);
                     //this is safe because extension cells are ignored when reading
                     me->removeFormulaDependents(ptr);
+                    me->m_dependencies.add(ptr);
+                    me->markStale(ptr);
                 }
                 movedCell = std::move(cell);
                 return -int(!std::is_same_v<T, std::nullptr_t>);
@@ -402,12 +852,13 @@ struct Sheet::MoveCell {
             if constexpr (std::is_same_v<T, FormulaCellExtension>) {
                 if (movedCell) {
                     me->removeFormulaDependents(ptr->parent());
+                    me->markStale(ptr->parent());
                     cell = std::move(movedCell);
                 }
                 return 0;
             } else {
                 if constexpr (std::is_same_v<T, FormulaCell>) {
-                    me->m_formulaCells.erase(*ptr);
+                    me->eraseFormulaCell(ptr);
                     //this is safe because extension cells are ignored when reading
                     me->removeFormulaDependents(ptr);
                 } 
@@ -427,6 +878,8 @@ void Sheet::moveCell(Point from, Point to) {
 
     m_grid.transformCell(from, Rect{to, Size{1, 1}}, MoveCell{this});
     //TODO: adjust incoming references
+    markChanged(from);
+    markChanged(to);
     recalcIfNotSuspended();
 }
 
@@ -434,6 +887,8 @@ void Sheet::moveCells(Rect from, Point to) {
 
     m_grid.transformCells(from, to, MoveCell{this});
     //TODO: adjust incoming references
+    markChanged(from);
+    markChanged(Rect{to, from.size});
     recalcIfNotSuspended();
 }
 
@@ -463,12 +918,16 @@ void Sheet::deleteRows(SizeType y, SizeType count) {
     if (count == 0)
         return;
 
+    //Structural changes move everything around so simply recalculate and reindex all formulas
+    markAllStale();
+
     for(auto it = m_formulaCells.begin(), end = m_formulaCells.end(); it != end; ) {
         auto formula = &*it;
         auto formulaLoc = formula->location();
         if (formulaLoc.y >= y && formulaLoc.y < y + count) {
             //if formula is in the deletion area get rid of all extra records for it
             removeFormulaDependents(formula);
+            m_staleFormulaCells.erase(formula);
             it = m_formulaCells.erase(it);
         } else {
             
@@ -499,6 +958,7 @@ void Sheet::deleteRows(SizeType y, SizeType count) {
 
     m_grid.deleteRows(y, count, SimpleMoveCell{});
     m_rowHeights.eraseIndices(y, y + count);
+    reindexFormulaCells();
 
     recalcIfNotSuspended();
 }
@@ -510,12 +970,16 @@ void Sheet::deleteColumns(SizeType x, SizeType count) {
     if (count == 0)
         return;
 
+    //Structural changes move everything around so simply recalculate and reindex all formulas
+    markAllStale();
+
     for(auto it = m_formulaCells.begin(), end = m_formulaCells.end(); it != end; ) {
         auto formula = &*it;
         auto formulaLoc = formula->location();
         if (formulaLoc.x >= x && formulaLoc.x < x + count) {
             //if formula is in the deletion area get rid of all extra records for it
             removeFormulaDependents(formula);
+            m_staleFormulaCells.erase(formula);
             it = m_formulaCells.erase(it);
         } else {
             
@@ -545,6 +1009,7 @@ void Sheet::deleteColumns(SizeType x, SizeType count) {
     }
     m_grid.deleteColumns(x, count, SimpleMoveCell{});
     m_columnWidths.eraseIndices(x, x + count);
+    reindexFormulaCells();
 
     recalcIfNotSuspended();
 }
@@ -581,6 +1046,8 @@ void Sheet::insertRows(SizeType y, SizeType count) {
     //Unlike deletion here we first insert (skipping extensions), then adjust.  
     m_grid.insertRows(y, count, InsertionMoveCell{});
 
+    markAllStale();
+
     for(auto it = m_formulaCells.begin(), end = m_formulaCells.end(); it != end; ++it) {
         auto formula = &*it;
         auto formulaLoc = formula->location();
@@ -599,6 +1066,7 @@ void Sheet::insertRows(SizeType y, SizeType count) {
     }
     
     m_rowHeights.insertIndices(y, count);
+    reindexFormulaCells();
 
     recalcIfNotSuspended();
 }
@@ -608,6 +1076,8 @@ void Sheet::insertColumns(SizeType x, SizeType count) {
     //Unlike deletion here we first insert (skipping extensions), then adjust.  
     m_grid.insertColumns(x, count, InsertionMoveCell{});
 
+    markAllStale();
+
     for(auto it = m_formulaCells.begin(), end = m_formulaCells.end(); it != end; ++it) {
         auto formula = &*it;
         auto formulaLoc = formula->location();
@@ -626,6 +1096,7 @@ void Sheet::insertColumns(SizeType x, SizeType count) {
     }
 
     m_columnWidths.insertIndices(x, count);
+    reindexFormulaCells();
     
     recalcIfNotSuspended();
 }
@@ -663,6 +1134,21 @@ inline void Sheet::unhideLength(LengthMap & map, SizeType start, SizeType end) {
     });
 }
 
+auto Sheet::cells(Rect rect) const -> CoroGenerator<std::tuple<Point, const Scalar &, bool>> {
+
+    SPR_ASSERT_INPUT(rect.origin.x < maxSize().width && rect.origin.y < maxSize().height);
+
+    using RetType = std::tuple<Point, const Scalar &, bool>;
+
+    for (auto [pt, cell]: m_grid.cells(rect)) {
+        bool isFormula = cell.getType() == CellType::Formula;
+        Scalar value = cell.value();
+        if (!isFormula && value.isBlank())
+            continue;
+        co_yield RetType(pt, value, isFormula);
+    }
+}
+
 void Sheet::setRowHeight(SizeType y, SizeType count, LengthType height) {
     SPR_ASSERT_INPUT(y < maxSize().height && count <= maxSize().height && maxSize().height - count >= y);
     m_grid.expandHeightToAtLeast(y + count);
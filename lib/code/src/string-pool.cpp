@@ -0,0 +1,25 @@
+// Copyright (c) 2022, Eugene Gershnik
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <spreader/string-pool.h>
+
+using namespace Spreader;
+
+auto StringPool::intern(const String & str) -> String {
+
+    auto [it, inserted] = m_strings.insert(str);
+    if (inserted) {
+        ++m_statistics.distinctCount;
+        m_statistics.storageSize += storageSize(str);
+    } else if (!StringEqual::sharesStorage(*it, str)) {
+        ++m_statistics.sharedCount;
+        m_statistics.savedSize += storageSize(str);
+    }
+    return *it;
+}
+
+void StringPool::clear() noexcept {
+    m_strings.clear();
+    m_statistics = Statistics{};
+    m_purgeThreshold = s_minPurgeThreshold;
+}
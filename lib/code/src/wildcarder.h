@@ -9,6 +9,8 @@
 
 #include <vector>
 #include <algorithm>
+#include <iterator>
+#include <string_view>
 
 namespace Spreader {
 
@@ -193,6 +195,143 @@ namespace Spreader {
     };
 
 
+    /**
+     A wildcard pattern compiled once to be matched against many strings.
+
+     The syntax is the same as of Wildcarder. The pattern is split at the stars into segments of fixed length.
+     The first segment must be at the start of the text, the last at its end and the ones in between are
+     looked for left to right, each at the first place it fits. Segments without '?' are looked for via
+     std::basic_string_view::find which is memchr/memcmp based when the text is contiguous.
+     */
+    template<class Char>
+    class WildcardPattern {
+
+    private:
+        struct Segment {
+            size_t start;
+            size_t size;
+            bool hasAny;
+        };
+
+    public:
+        template<class PatternIt>
+        requires(std::is_same_v<std::remove_const_t<typename std::iterator_traits<PatternIt>::value_type>, Char>)
+        WildcardPattern(PatternIt first, PatternIt last, Char escape) {
+
+            m_segments.push_back({0, 0, false});
+            bool inEscape = false;
+            for ( ; first != last; ++first) {
+
+                Char c = *first;
+
+                if (inEscape) {
+                    inEscape = false;
+                    if (c != Char('*') && c != Char('?') && c != escape)
+                        append(escape, false);
+                    append(c, false);
+                } else if (c == Char('*')) {
+                    //consecutive stars are the same as one
+                    if (m_segments.size() == 1 || m_segments.back().size != 0)
+                        m_segments.push_back({m_chars.size(), 0, false});
+                } else if (c == escape) {
+                    inEscape = true;
+                } else if (c == Char('?')) {
+                    append(Char(), true);
+                } else {
+                    append(c, false);
+                }
+            }
+            if (inEscape)
+                append(escape, false);
+        }
+
+        template<class PCont>
+        WildcardPattern(const PCont & pattern, Char escape):
+            WildcardPattern(std::begin(pattern), std::end(pattern), escape)
+        {}
+
+        template<class TCont>
+        SPR_ALWAYS_INLINE auto match(const TCont & text) const -> bool
+            { return match(std::begin(text), std::end(text)); }
+
+        template<class TextIt>
+        requires(std::is_same_v<std::remove_const_t<typename std::iterator_traits<TextIt>::value_type>, Char>)
+        auto match(TextIt first, TextIt last) const -> bool {
+
+            size_t size = size_t(std::distance(first, last));
+
+            const Segment & head = m_segments.front();
+            if (m_segments.size() == 1)
+                return size == head.size && matchAt(head, first);
+
+            const Segment & tail = m_segments.back();
+            if (size < head.size + tail.size || !matchAt(head, first))
+                return false;
+            std::advance(first, head.size);
+            size -= head.size + tail.size;
+            auto tailFirst = std::next(first, size);
+
+            for (size_t i = 1; i < m_segments.size() - 1; ++i) {
+                const Segment & segment = m_segments[i];
+                auto found = find(segment, first, size);
+                if (found == size)
+                    return false;
+                std::advance(first, found + segment.size);
+                size -= found + segment.size;
+            }
+            return matchAt(tail, tailFirst);
+        }
+
+    private:
+        void append(Char c, bool any) {
+            m_chars.push_back(c);
+            m_any.push_back(any);
+            auto & segment = m_segments.back();
+            ++segment.size;
+            segment.hasAny = segment.hasAny || any;
+        }
+
+        template<class TextIt>
+        auto matchAt(const Segment & segment, TextIt first) const -> bool {
+
+            const Char * chars = m_chars.data() + segment.start;
+            if (!segment.hasAny)
+                return std::equal(chars, chars + segment.size, first);
+            for (size_t i = 0; i < segment.size; ++i, ++first) {
+                if (!m_any[segment.start + i] && chars[i] != *first)
+                    return false;
+            }
+            return true;
+        }
+
+        ///Returns the offset of the segment in [first, first + size) or size if not found
+        template<class TextIt>
+        auto find(const Segment & segment, TextIt first, size_t size) const -> size_t {
+
+            if (segment.size > size)
+                return size;
+
+            if constexpr (std::is_pointer_v<TextIt>) {
+                if (!segment.hasAny) {
+                    std::basic_string_view<Char> text(first, size);
+                    auto found = text.find(std::basic_string_view<Char>(m_chars.data() + segment.start, segment.size));
+                    return found == text.npos ? size : found;
+                }
+            }
+            for (size_t offset = 0; offset <= size - segment.size; ++offset, ++first) {
+                if (matchAt(segment, first))
+                    return offset;
+            }
+            return size;
+        }
+
+    private:
+        std::vector<Char> m_chars;
+        ///Whether the corresponding char in m_chars is '?'
+        std::vector<bool> m_any;
+        std::vector<Segment> m_segments;
+    };
+
 }
 
 #endif
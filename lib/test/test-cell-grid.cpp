@@ -4,6 +4,8 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/benchmark/catch_benchmark.hpp>
 
+#include <vector>
+
 using namespace Spreader;
 
 static_assert(CellGrid::maxSize() == Spreader::Size{(1u << 16) - 1, (1u << 31) - 1});
@@ -32,7 +34,7 @@ TEST_CASE( "Empty grid works", "[cell_grid]" ) {
 
     grid.modifyCell({0, 0}, SetCell{ValueCell::create(1.)});
     REQUIRE(grid.size() == Spreader::Size{1, 1});
-    REQUIRE(grid.getCell({0, 0})->value() == 1.);
+    REQUIRE(grid.getCell({0, 0}).value() == 1.);
 
 }
 
@@ -42,7 +44,7 @@ TEST_CASE( "Single cell access", "[cell_grid]" ) {
 
     grid.modifyCell({42, 642}, SetCell{ValueCell::create(0.)});
     REQUIRE(grid.size() == Spreader::Size{43, 643});
-    REQUIRE(grid.getCell({42, 642})->value() == 0.);
+    REQUIRE(grid.getCell({42, 642}).value() == 0.);
     REQUIRE(grid.getCell({42, 641}) == nullptr);
     REQUIRE(grid.getCell({41, 642}) == nullptr);
 
@@ -61,6 +63,132 @@ TEST_CASE( "Single cell access", "[cell_grid]" ) {
 
 }
 
+TEST_CASE( "Inline values", "[cell_grid]" ) {
+
+    const Scalar values[] = {
+        0., -0., 1., -1.5, 1e308, -1e308, 5e-324, -5e-324, 
+        true, false, 
+        Error::DivisionByZero, Error::InvalidFormula, 
+        Scalar::Blank{}
+    };
+    for (auto & value: values) {
+        auto ref = CellRef::inlineFor(value);
+        REQUIRE(ref);
+        CHECK(ref->isInline());
+        CHECK(bool(*ref));
+        CHECK(ref->get() == nullptr);
+        CHECK(ref->getType() == CellType::Value);
+        CHECK(ref->value() == value);
+    }
+    CHECK(!CellRef::inlineFor(SPRS("abc")));
+
+    CellGrid grid;
+    grid.modifyCell({3, 4}, SetCell{CellPtr::fromValue(-2.5)});
+    grid.modifyCell({4, 4}, SetCell{CellPtr::fromValue(SPRS("abc"))});
+    CHECK(grid.nonNullCellCount() == 2);
+    CHECK(grid.getCell({3, 4}).isInline());
+    CHECK(grid.getCell({3, 4}).value() == -2.5);
+    CHECK(!grid.getCell({4, 4}).isInline());
+    CHECK(grid.getCell({4, 4}).value() == SPRS("abc"));
+    grid.modifyCell({3, 4}, SetCell{});
+    CHECK(grid.getCell({3, 4}) == nullptr);
+    CHECK(grid.nonNullCellCount() == 1);
+}
+
+TEST_CASE( "Range traversal", "[cell_grid]" ) {
+
+    CellGrid grid;
+
+    //spread over several leaf and intermediate tiles
+    std::vector<Point> points = {
+        {3, 0}, {300, 0}, {5000, 0}, {0, 1}, {255, 2047}, {256, 2047}, {1, 2048}, 
+        {0, 3'000'000}, {60'000, 3'000'000}, {2, 100'000'000}
+    };
+    for (auto pt: points)
+        grid.modifyCell(pt, SetCell{ValueCell::create(double(pt.x))});
+
+    auto collect = [&](Rect rect) {
+        std::vector<Point> ret;
+        bool completed = grid.forEachCell(rect, [&](Point pt, CellRef cell) {
+            REQUIRE(cell == grid.getCell(pt));
+            ret.push_back(pt);
+        });
+        REQUIRE(completed);
+        return ret;
+    };
+    
+    CHECK(collect(Rect{{0, 0}, CellGrid::maxSize()}) == points);
+    CHECK(collect(Rect{{1, 0}, Spreader::Size{300, 2049}}) == std::vector<Point>{{3, 0}, {300, 0}, {255, 2047}, {256, 2047}, {1, 2048}});
+    CHECK(collect(Rect{{0, 2048}, Spreader::Size{1, CellGrid::maxSize().height - 2048}}) == std::vector<Point>{{0, 3'000'000}});
+    CHECK(collect(Rect{{4, 1}, Spreader::Size{250, 2000}}).empty());
+    CHECK(collect(Rect{{0, 200'000'000}, Spreader::Size{10, 10}}).empty());
+
+    size_t count = 0;
+    bool completed = grid.forEachCell(Rect{{0, 0}, CellGrid::maxSize()}, [&](Point, CellRef) {
+        return ++count < 3;
+    });
+    CHECK(!completed);
+    CHECK(count == 3);
+}
+
+TEST_CASE( "Sparse and dense leaves", "[cell_grid]" ) {
+
+    CellGrid grid;
+
+    //fill a single leaf well past the sparse limit in a scrambled order
+    const Spreader::Size area{256, 64};
+    const SizeType count = area.width * area.height;
+    for (SizeType i = 0; i < count; ++i) {
+        SizeType idx = (i * 7919) % count;
+        grid.modifyCell({idx % area.width, idx / area.width}, SetCell{ValueCell::create(double(idx))});
+    }
+    REQUIRE(grid.nonNullCellCount() == count);
+    for (SizeType idx = 0; idx < count; ++idx)
+        REQUIRE(grid.getCell({idx % area.width, idx / area.width}).value() == double(idx));
+
+    SizeType visited = 0;
+    grid.forEachCell(Rect{{0, 0}, area}, [&](Point pt, CellRef cell) {
+        REQUIRE(pt == Point{visited % area.width, visited / area.width});
+        REQUIRE(cell.value() == double(visited));
+        ++visited;
+    });
+    CHECK(visited == count);
+
+    for (SizeType idx = 0; idx < count; idx += 2)
+        grid.modifyCell({idx % area.width, idx / area.width}, SetCell{});
+    CHECK(grid.nonNullCellCount() == count / 2);
+    CHECK(grid.getCell({0, 0}) == nullptr);
+    CHECK(grid.getCell({1, 0}).value() == 1.);
+}
+
+TEST_CASE( "Memory usage", "[cell_grid]" ) {
+
+    constexpr size_t denseLeafSize = (size_t(1) << 19) * sizeof(CellRef);
+
+    SECTION("scattered") {
+        CellGrid grid;
+        for (SizeType i = 0; i < 1000; ++i)
+            grid.modifyCell({(i * 37) % 26, (i * 7919) % 100'000}, SetCell{ValueCell::create(1.)});
+        CHECK(grid.memoryUsage() < 1024 * 1024);
+    }
+
+    SECTION("banded") {
+        CellGrid grid;
+        for (SizeType y = 0; y < 100'000; ++y)
+            grid.modifyCell({3, y}, SetCell{ValueCell::create(1.)});
+        CHECK(grid.memoryUsage() < 4 * 1024 * 1024);
+    }
+
+    SECTION("dense") {
+        CellGrid grid;
+        for (SizeType y = 0; y < 2048; ++y)
+            for (SizeType x = 0; x < 256; ++x)
+                grid.modifyCell({x, y}, SetCell{ValueCell::create(1.)});
+        CHECK(grid.memoryUsage() >= denseLeafSize);
+        CHECK(grid.memoryUsage() < denseLeafSize + 1024 * 1024);
+    }
+}
+
 #ifdef NDEBUG
 TEST_CASE( "Speed test", "[cell_grid]" ) {
 
@@ -80,7 +208,7 @@ TEST_CASE( "Speed test", "[cell_grid]" ) {
     BENCHMARK("getting cells") {
         for(SizeType x = 250; x < 300; ++x) {
             for(SizeType y = 4000; y < 5000; ++y) {
-                [[maybe_unused]] auto * volatile dummy = grid.getCell(Spreader::Point{x, y});
+                [[maybe_unused]] auto * volatile dummy = grid.getCell(Spreader::Point{x, y}).get();
             }
         }
     };
@@ -252,3 +252,49 @@ TEST_CASE( "Negative Matching", "[formula][formula-match]" ) {
     CHECK(s.getFormulaInfo(PT("A1"))->extent == Spreader::Size{1, 1});
 }
 
+
+TEST_CASE( "Matching in large sorted ranges", "[formula][formula-match]" ) {
+
+    Sheet s;
+
+    for (SizeType y = 0; y < 200; ++y) {
+        s.setValueCell(Point{0, y}, 2 * (y + 1));
+        char buf[8];
+        snprintf(buf, sizeof(buf), "k%03u", unsigned(y));
+        s.setValueCell(Point{2, y}, String(buf));
+        s.setValueCell(Point{4, y}, 1000 - 5 * int(y + 1));
+    }
+
+    //the first lookup in an area bisects the cells and the second one uses the shared index
+    auto check = [&](SizeType y, const char * formula) {
+        s.setFormulaCell(Point{6, y}, String(formula));
+        s.setFormulaCell(Point{7, y}, String(formula));
+        CHECK(s.getValue(Point{6, y}) == s.getValue(Point{7, y}));
+        return s.getValue(Point{7, y});
+    };
+
+    CHECK(check(0, "MATCH(7, $A$1:$A$200, 1)") == 3);
+    CHECK(check(1, "MATCH(1, $A$1:$A$200, 1)") == Error::InvalidArgs);
+    CHECK(check(2, "MATCH(1000, $A$1:$A$200, 1)") == 200);
+    CHECK(check(3, "MATCH(\"k050x\", $C:$C, 1)") == 51);
+    CHECK(check(4, "MATCH(\"k\", $C:$C, 1)") == Error::InvalidArgs);
+    CHECK(check(5, "MATCH(990, $E$1:$E$200, -1)") == 2);
+    CHECK(check(6, "MATCH(992, $E$1:$E$200, -1)") == 1);
+    CHECK(check(7, "MATCH(2000, $E$1:$E$200, -1)") == Error::InvalidArgs);
+    CHECK(check(8, "MATCH(1, $E$1:$E$200, -1)") == 199);
+    CHECK(check(9, "VLOOKUP(7, $A$1:$C$200, 3, TRUE)") == "k002");
+    CHECK(check(10, "MATCH(TRUE, $A$1:$A$200, 1)") == Error::InvalidArgs);
+
+    s.setValueCell(PT("A4"), 7);
+    CHECK(s.getValue(PT("H1")) == 4);
+    s.setValueCell(PT("A150"), "x");
+    CHECK(s.getValue(PT("H3")) == 200);
+    CHECK(s.getValue(PT("H11")) == Error::InvalidArgs);
+    s.setValueCell(PT("A150"), true);
+    CHECK(s.getValue(PT("H11")) == 150);
+
+    //not sorted anymore: both use bisection
+    s.setValueCell(PT("A10"), 1000);
+    CHECK(s.getValue(PT("G1")) == s.getValue(PT("H1")));
+    CHECK(s.getValue(PT("G3")) == s.getValue(PT("H3")));
+}
@@ -198,3 +198,58 @@ TEST_CASE( "Formula Parser", "[formula]" ) {
     }
 
 }
+
+TEST_CASE( "Constant folding", "[formula]" ) {
+
+    AstNode::ExecutionMemoryResource memory;
+    CellGrid grid;
+    NameManager nm;
+    grid.modifyCell({0, 0}, SetCell{ValueCell::create(Scalar(2.))});
+
+    {
+        auto [f, refs] = Formula::parse(SPRS("A1*(24*60*60)"), {1, 1});
+        CHECK(f->reconstructAt(refs, {1, 1}) == SPRS("A1 * (24 * 60 * 60)"));
+        FormulaEvaluator fev(memory, grid, nm, f, refs, {1, 1}, false);
+        REQUIRE(fev.eval());
+        CHECK(fev.extent() == Spreader::Size{1, 1});
+        CHECK(fev.result() == 172800.);
+    }
+
+    {
+        auto [f, refs] = Formula::parse(SPRS("(1+2)*3 & \"x\""), {0, 0});
+        CHECK(f->reconstructAt(refs, {0, 0}) == SPRS("(1 + 2) * 3 & \"x\""));
+        FormulaEvaluator fev(memory, grid, nm, f, refs, {0, 0}, false);
+        REQUIRE(fev.eval());
+        CHECK(fev.extent() == Spreader::Size{1, 1});
+        CHECK(fev.result() == SPRS("9x"));
+    }
+
+    {
+        auto [f, refs] = Formula::parse(SPRS("{1,2}*2"), {1, 1});
+        CHECK(f->reconstructAt(refs, {1, 1}) == SPRS("{1,2} * 2"));
+        FormulaEvaluator fev(memory, grid, nm, f, refs, {1, 1}, false);
+        REQUIRE(fev.eval());
+        REQUIRE(fev.extent() == Spreader::Size{2, 1});
+        CHECK(fev.result() == 2.);
+        REQUIRE(fev.nextOffset());
+        REQUIRE(fev.eval());
+        CHECK(fev.result() == 4.);
+        CHECK(!fev.nextOffset());
+    }
+
+    {
+        auto [f, refs] = Formula::parse(SPRS("IF(LEN(\"abc\")=3, A1, 1/0)"), {1, 1});
+        CHECK(f->reconstructAt(refs, {1, 1}) == SPRS("IF(LEN(\"abc\") = 3, A1, 1 / 0)"));
+        FormulaEvaluator fev(memory, grid, nm, f, refs, {1, 1}, false);
+        REQUIRE(fev.eval());
+        CHECK(fev.extent() == Spreader::Size{1, 1});
+        CHECK(fev.result() == 2.);
+    }
+
+    {
+        auto [f, refs] = Formula::parse(SPRS("INDIRECT(\"A1\")*ROW()"), {1, 1});
+        FormulaEvaluator fev(memory, grid, nm, f, refs, {1, 1}, false);
+        REQUIRE(fev.eval());
+        CHECK(fev.result() == 4.);
+    }
+}
@@ -0,0 +1,126 @@
+#include <spreader/sheet.h>
+#include "test-util.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace Spreader;
+
+
+TEST_CASE( "Multiple criteria", "[formula][formula-sumifs]" ) {
+
+    Sheet s;
+
+    s.setValueCell(PT("A1"), SPRS("apple"));
+    s.setValueCell(PT("A2"), SPRS("pear"));
+    s.setValueCell(PT("A3"), SPRS("apple"));
+    s.setValueCell(PT("A4"), SPRS("plum"));
+    s.setValueCell(PT("A5"), SPRS("apple"));
+
+    s.setValueCell(PT("B1"), 1);
+    s.setValueCell(PT("B2"), 2);
+    s.setValueCell(PT("B3"), 3);
+    s.setValueCell(PT("B5"), 5);
+
+    s.setValueCell(PT("C1"), 10);
+    s.setValueCell(PT("C2"), 20);
+    s.setValueCell(PT("C3"), 30);
+    s.setValueCell(PT("C4"), 40);
+    s.setValueCell(PT("C5"), 50);
+
+    s.setFormulaCell(PT("E1"), "SUMIFS(C1:C5, A1:A5, \"apple\")");
+    CHECK(s.getValue(PT("E1")) == 90);
+    s.setFormulaCell(PT("E1"), "SUMIFS(C1:C5, A1:A5, \"APPLE\", B1:B5, \">1\")");
+    CHECK(s.getValue(PT("E1")) == 80);
+    s.setFormulaCell(PT("E1"), "SUMIFS(C1:C5, A1:A5, \"p*\", B1:B5, \"\")");
+    CHECK(s.getValue(PT("E1")) == 40);
+    s.setFormulaCell(PT("E1"), "SUMIFS(C1:C5, B1:B5, \">10\")");
+    CHECK(s.getValue(PT("E1")) == 0);
+
+    s.setFormulaCell(PT("E1"), "COUNTIFS(A1:A5, \"apple\", B1:B5, \"<5\")");
+    CHECK(s.getValue(PT("E1")) == 2);
+    s.setFormulaCell(PT("E1"), "COUNTIFS(B1:B5, \"\")");
+    CHECK(s.getValue(PT("E1")) == 1);
+    s.setFormulaCell(PT("E1"), "COUNTIFS(B1:C5, \">=5\")");
+    CHECK(s.getValue(PT("E1")) == 6);
+
+    s.setFormulaCell(PT("E1"), "COUNTIF(A1:A5, \"apple\")");
+    CHECK(s.getValue(PT("E1")) == 3);
+    s.setFormulaCell(PT("E1"), "COUNTIF(A1:A10, \"<>apple\")");
+    CHECK(s.getValue(PT("E1")) == 7);
+
+    s.setFormulaCell(PT("E1"), "AVERAGEIFS(C1:C5, A1:A5, \"apple\", B1:B5, \">=3\")");
+    CHECK(s.getValue(PT("E1")) == 40);
+    s.setFormulaCell(PT("E1"), "AVERAGEIFS(C1:C5, A1:A5, \"kiwi\")");
+    CHECK(s.getValue(PT("E1")) == 0);
+
+    s.setFormulaCell(PT("E1"), "SUMIFS(C1:C5, A1:A5, {\"apple\";\"pear\"})");
+    CHECK(s.getValue(PT("E1")) == 90);
+    CHECK(s.getValue(PT("E2")) == 20);
+}
+
+TEST_CASE( "Criteria on calculated cells", "[formula][formula-sumifs]" ) {
+
+    Sheet s;
+
+    for (SizeType i = 0; i < 10; ++i) {
+        s.setFormulaCell(Point{0, i}, "ROW() * 2");
+        s.setFormulaCell(Point{1, i}, "IF(MOD(ROW(), 2) = 0, \"even\", \"odd\")");
+        s.setValueCell(Point{2, i}, 1);
+    }
+
+    s.setFormulaCell(PT("E1"), "SUMIFS(A1:A10, B1:B10, \"even\", A1:A10, \">4\")");
+    CHECK(s.getValue(PT("E1")) == 8 + 12 + 16 + 20);
+    s.setFormulaCell(PT("E2"), "COUNTIFS(C1:C10, 1, B1:B10, \"odd\")");
+    CHECK(s.getValue(PT("E2")) == 5);
+
+    s.setValueCell(PT("C1"), 2);
+    CHECK(s.getValue(PT("E2")) == 4);
+
+    s.setFormulaCell(PT("A2"), "E1");
+    CHECK(s.getValue(PT("E1")) == Error::InvalidReference);
+}
+
+TEST_CASE( "Multiple criteria bad arguments", "[formula][formula-sumifs]" ) {
+
+    Sheet s;
+
+    s.setFormulaCell(PT("E1"), "SUMIFS(7, A1:A5, \"a\")");
+    CHECK(s.getValue(PT("E1")) == Error::InvalidFormula);
+    s.setFormulaCell(PT("E1"), "SUMIFS(C1:C5, \"abc\", \"a\")");
+    CHECK(s.getValue(PT("E1")) == Error::InvalidFormula);
+    s.setFormulaCell(PT("E1"), "SUMIFS(C1:C5, A1:A5, \"a\", B1:B5)");
+    CHECK(s.getValue(PT("E1")) == Error::InvalidFormula);
+    s.setFormulaCell(PT("E1"), "COUNTIFS(A1:A5, \"a\", B1:B4, \"b\")");
+    CHECK(s.getValue(PT("E1")) == Error::InvalidValue);
+    s.setFormulaCell(PT("E1"), "SUMIFS(C1:C4, A1:A5, \"a\")");
+    CHECK(s.getValue(PT("E1")) == Error::InvalidValue);
+}
+
+TEST_CASE( "Multiple criteria in large ranges", "[formula][formula-sumifs]" ) {
+
+    Sheet s;
+
+    double expectedSum = 0;
+    unsigned expectedCount = 0;
+    unsigned expectedOtherCount = 0;
+    for (SizeType i = 0; i < 5000; ++i) {
+        //column A is sparse, column B rarely matches
+        if (i % 3 == 0)
+            s.setValueCell(Point{0, i}, i % 2 ? SPRS("x") : SPRS("y"));
+        s.setValueCell(Point{1, i}, i % 100);
+        s.setValueCell(Point{2, i}, i);
+        if (i % 3 == 0 && i % 2 == 0 && i % 100 < 10) {
+            expectedSum += i;
+            ++expectedCount;
+        }
+        if ((i % 3 != 0 || i % 2 != 0) && i % 100 >= 10)
+            ++expectedOtherCount;
+    }
+
+    s.setFormulaCell(PT("E1"), "SUMIFS(C1:C5000, A1:A5000, \"y\", B1:B5000, \"<10\")");
+    CHECK(s.getValue(PT("E1")) == expectedSum);
+    s.setFormulaCell(PT("E2"), "COUNTIFS(A:A, \"y\", B:B, \"<10\")");
+    CHECK(s.getValue(PT("E2")) == expectedCount);
+    s.setFormulaCell(PT("E3"), "COUNTIFS(A1:A5000, \"<>y\", B1:B5000, \">=10\")");
+    CHECK(s.getValue(PT("E3")) == expectedOtherCount);
+}
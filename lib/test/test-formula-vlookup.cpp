@@ -152,6 +152,67 @@ TEST_CASE( "Exact Matching", "[formula][formula-vlookup]" ) {
     CHECK(s.getFormulaInfo(PT("A1"))->extent == Spreader::Size{1, 1});
 }
 
+TEST_CASE( "Exact Matching in large tables", "[formula][formula-vlookup]" ) {
+
+    Sheet s;
+
+    for (SizeType y = 0; y < 200; ++y) {
+        s.setValueCell(Point{0, y}, y + 1);
+        s.setValueCell(Point{1, y}, 2 * (y + 1));
+    }
+    s.setValueCell(PT("A50"), "key");
+    s.setValueCell(PT("A60"), true);
+    s.setValueCell(PT("F1"), 100);
+    s.setFormulaCell(PT("A100"), "F1*10");
+    s.clearCell(PT("A150"));
+
+    //all of these look up in the same area
+    s.setFormulaCell(PT("D1"), "VLOOKUP(7, $A$1:$B$200, 2, FALSE)");
+    s.setFormulaCell(PT("D2"), "VLOOKUP(7, $A$1:$B$200, 2, FALSE)");
+    s.setFormulaCell(PT("D3"), "VLOOKUP(\"key\", $A$1:$B$200, 2, FALSE)");
+    s.setFormulaCell(PT("D4"), "VLOOKUP(TRUE, $A$1:$B$200, 2, FALSE)");
+    s.setFormulaCell(PT("D5"), "VLOOKUP(1000, $A$1:$B$200, 2, FALSE)");
+    s.setFormulaCell(PT("D6"), "VLOOKUP(0, $A$1:$B$200, 2, FALSE)");
+    s.setFormulaCell(PT("D7"), "VLOOKUP(\"k*\", $A$1:$B$200, 2, FALSE)");
+    s.setFormulaCell(PT("D8"), "VLOOKUP(12345, $A$1:$B$200, 2, FALSE)");
+    s.setFormulaCell(PT("D9"), "MATCH(7, $A$1:$A$200, 0)");
+
+    CHECK(s.getValue(PT("D1")) == 14);
+    CHECK(s.getValue(PT("D2")) == 14);
+    CHECK(s.getValue(PT("D3")) == 100);
+    CHECK(s.getValue(PT("D4")) == 120);
+    CHECK(s.getValue(PT("D5")) == 200);
+    CHECK(s.getValue(PT("D6")) == 300);
+    CHECK(s.getValue(PT("D7")) == 100);
+    CHECK(s.getValue(PT("D8")) == Error::InvalidArgs);
+    CHECK(s.getValue(PT("D9")) == 7);
+
+    //edits inside the area are seen
+    s.setValueCell(PT("A7"), 700);
+    CHECK(s.getValue(PT("D1")) == Error::InvalidArgs);
+    CHECK(s.getValue(PT("D9")) == Error::InvalidArgs);
+    s.setValueCell(PT("A3"), 7);
+    CHECK(s.getValue(PT("D1")) == 6);
+    CHECK(s.getValue(PT("D2")) == 6);
+    CHECK(s.getValue(PT("D9")) == 3);
+    s.setValueCell(PT("A150"), 5);
+    CHECK(s.getValue(PT("D6")) == Error::InvalidArgs);
+
+    //so are recalculated formulas
+    s.setValueCell(PT("F1"), 0.7);
+    CHECK(s.getValue(PT("D5")) == Error::InvalidArgs);
+    CHECK(s.getValue(PT("D1")) == 6);
+    s.setValueCell(PT("A3"), 3);
+    CHECK(s.getValue(PT("D1")) == 200);
+    CHECK(s.getValue(PT("D9")) == 100);
+
+    //a lookup inside its own area
+    s.setFormulaCell(PT("A180"), "MATCH(4, $A$1:$A$200, 0)");
+    CHECK(s.getValue(PT("A180")) == 4);
+    s.setFormulaCell(PT("D10"), "MATCH(4, $A$1:$A$200, 0)");
+    CHECK(s.getValue(PT("D10")) == 4);
+}
+
 TEST_CASE( "Inexact Matching", "[formula][formula-vlookup]" ) {
     
     Sheet s;
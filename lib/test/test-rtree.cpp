@@ -0,0 +1,101 @@
+#include <spreader/rtree.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace Spreader;
+
+namespace {
+
+    auto intersecting(const RTree<unsigned> & tree, Rect rect) -> std::vector<unsigned> {
+        std::vector<unsigned> ret;
+        tree.forEachIntersecting(rect, [&](Rect, unsigned value) {
+            ret.push_back(value);
+        });
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }
+
+    auto bruteForce(const std::vector<Rect> & rects, Rect rect) -> std::vector<unsigned> {
+        std::vector<unsigned> ret;
+        for (unsigned i = 0; i < rects.size(); ++i) {
+            if (intersects(rects[i], rect))
+                ret.push_back(i);
+        }
+        return ret;
+    }
+}
+
+TEST_CASE( "Empty rtree", "[rtree]" ) {
+
+    RTree<unsigned> tree;
+    CHECK(tree.empty());
+    CHECK(intersecting(tree, Rect{{0, 0}, {100, 100}}).empty());
+    CHECK(!tree.erase(Rect{{0, 0}, {1, 1}}, 0));
+}
+
+TEST_CASE( "Small rtree", "[rtree]" ) {
+
+    RTree<unsigned> tree;
+    tree.insert(Rect{{0, 0}, {1, 10}}, 1);
+    tree.insert(Rect{{2, 2}, {3, 3}}, 2);
+    tree.insert(Rect{{2, 2}, {3, 3}}, 3);
+    CHECK(tree.size() == 3);
+
+    CHECK(intersecting(tree, Rect{{0, 5}, {1, 1}}) == std::vector<unsigned>{1});
+    CHECK(intersecting(tree, Rect{{1, 0}, {1, 10}}).empty());
+    CHECK(intersecting(tree, Rect{{4, 4}, {10, 10}}) == std::vector<unsigned>{2, 3});
+    CHECK(intersecting(tree, Rect{{0, 0}, {5, 5}}) == std::vector<unsigned>{1, 2, 3});
+
+    CHECK(!tree.erase(Rect{{2, 2}, {3, 3}}, 1));
+    CHECK(tree.erase(Rect{{2, 2}, {3, 3}}, 2));
+    CHECK(intersecting(tree, Rect{{0, 0}, {5, 5}}) == std::vector<unsigned>{1, 3});
+    CHECK(tree.size() == 2);
+}
+
+TEST_CASE( "Large rtree", "[rtree]" ) {
+
+    RTree<unsigned> tree;
+    std::vector<Rect> rects;
+
+    //deterministic pseudo-random mix of cells, rows, columns and blocks
+    uint32_t seed = 12345;
+    auto next = [&](uint32_t max) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) % max;
+    };
+    for (unsigned i = 0; i < 2000; ++i) {
+        Rect rect{{next(500), next(500)}, {next(4) == 0 ? next(200) + 1 : 1, next(4) == 0 ? next(200) + 1 : 1}};
+        rects.push_back(rect);
+        tree.insert(rect, i);
+    }
+    CHECK(tree.size() == rects.size());
+
+    for (unsigned i = 0; i < 100; ++i) {
+        Rect query{{next(600), next(600)}, {next(50) + 1, next(50) + 1}};
+        REQUIRE(intersecting(tree, query) == bruteForce(rects, query));
+    }
+
+    std::vector<Rect> remaining;
+    for (unsigned i = 0; i < rects.size(); ++i) {
+        if (i % 3 != 0) {
+            REQUIRE(tree.erase(rects[i], i));
+            remaining.push_back(Rect{});
+        } else {
+            remaining.push_back(rects[i]);
+        }
+    }
+    CHECK(tree.size() == (rects.size() + 2) / 3);
+
+    for (unsigned i = 0; i < 100; ++i) {
+        Rect query{{next(600), next(600)}, {next(50) + 1, next(50) + 1}};
+        REQUIRE(intersecting(tree, query) == bruteForce(remaining, query));
+    }
+
+    for (unsigned i = 0; i < rects.size(); i += 3)
+        REQUIRE(tree.erase(rects[i], i));
+    CHECK(tree.empty());
+    CHECK(intersecting(tree, Rect{{0, 0}, {1000, 1000}}).empty());
+}
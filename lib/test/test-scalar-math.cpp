@@ -13,6 +13,42 @@ Scalar doAdd(Scalar lhs, Scalar rhs) {
 }
 
 
+TEST_CASE( "Scalar value semantics", "[scalar]" ) {
+
+    Scalar values[] = {Scalar(), Scalar(true), Scalar(2.5), Scalar(SPRS("haha")), Scalar(Error::InvalidName)};
+
+    for (auto & src: values) {
+        for (auto & dst: values) {
+            Scalar copy(src);
+            CHECK(copy == src);
+            Scalar assigned(dst);
+            assigned = copy;
+            CHECK(assigned == src);
+            Scalar moved(std::move(copy));
+            CHECK(moved == src);
+            Scalar moveAssigned(dst);
+            moveAssigned = std::move(moved);
+            CHECK(moveAssigned == src);
+            moveAssigned = moveAssigned;
+            CHECK(moveAssigned == src);
+
+            Scalar lhs(src), rhs(dst);
+            swap(lhs, rhs);
+            CHECK(lhs == dst);
+            CHECK(rhs == src);
+        }
+    }
+
+    Scalar val(SPRS("haha"));
+    val.assign(get<String>(val));
+    CHECK(val == Scalar(SPRS("haha")));
+    val.assign(SPRN(3.0));
+    CHECK(get<Number>(val) == 3);
+    CHECK(!get<String>(&val));
+    CHECK(val != Scalar(SPRS("haha")));
+    CHECK(Scalar(3) == Scalar(3.0));
+}
+
 TEST_CASE( "Scalar Addition", "[scalar]" ) {
 
     CHECK(doAdd(Scalar(), Scalar()) == Scalar(0.));
@@ -176,6 +176,107 @@ TEST_CASE( "Copy boundaries", "[sheet-copy-move]" ) {
     }
 }
 
+TEST_CASE( "Fill formula", "[sheet-copy-move]" ) {
+
+    Sheet s;
+    s.suspendRecalc();
+    for (SizeType y = 0; y < 100; ++y)
+        s.setValueCell(Point{0, y}, y + 1);
+    s.setFormulaCell(PT("B1"), "A1 * 2");
+    s.copyCell(PT("B1"), AREA("B1:B100"));
+    s.setFormulaCell(PT("C1"), "SUM(A$1:A1)");
+    s.copyCell(PT("C1"), AREA("C1:C100"));
+    s.setFormulaCell(PT("D2"), "$A$1 + COUNT(A:A)");
+    s.copyCell(PT("D2"), AREA("D1:E20"));
+    s.resumeRecalc();
+
+    CHECK(s.getFormulaInfo(PT("B50")) == Sheet::FormulaInfo{SPRS("A50 * 2"), Spreader::Size{1, 1}});
+    CHECK(s.getValue(PT("B50")) == 100);
+    CHECK(s.getValue(PT("C100")) == 5050);
+    CHECK(s.getValue(PT("E20")) == 101);
+
+    s.setValueCell(PT("A50"), 1000);
+    CHECK(s.getValue(PT("B49")) == 98);
+    CHECK(s.getValue(PT("B50")) == 2000);
+    CHECK(s.getValue(PT("B51")) == 102);
+    CHECK(s.getValue(PT("C49")) == 1225);
+    CHECK(s.getValue(PT("C50")) == 2225);
+    CHECK(s.getValue(PT("C100")) == 6000);
+
+    s.setValueCell(PT("A1"), 101);
+    CHECK(s.getValue(PT("B1")) == 202);
+    CHECK(s.getValue(PT("C100")) == 6100);
+    CHECK(s.getValue(PT("D1")) == 201);
+    CHECK(s.getValue(PT("E20")) == 201);
+
+    s.setValueCell(PT("A200"), 1);
+    CHECK(s.getValue(PT("D20")) == 202);
+    CHECK(s.getValue(PT("E20")) == 201);
+
+    s.setValueCell(PT("B60"), 7);
+    s.setFormulaCell(PT("B70"), "A1 + 1");
+    s.moveCell(PT("B80"), PT("F1"));
+    CHECK(s.getFormulaInfo(PT("F1")) == Sheet::FormulaInfo{SPRS("A80 * 2"), Spreader::Size{1, 1}});
+    s.setValueCell(PT("A60"), 1);
+    s.setValueCell(PT("A70"), 1);
+    s.setValueCell(PT("A80"), 1);
+    CHECK(s.getValue(PT("B60")) == 7);
+    CHECK(s.getValue(PT("B70")) == 102);
+    CHECK(s.getValue(PT("B80")) == Scalar::Blank{});
+    CHECK(s.getValue(PT("F1")) == 2);
+    s.setValueCell(PT("A1"), 1);
+    CHECK(s.getValue(PT("B70")) == 2);
+
+    s.clearCell(PT("A61"));
+    CHECK(s.getValue(PT("B61")) == 0);
+    
+    s.deleteRows(0, 1);
+    s.setValueCell(PT("A1"), 5);
+    CHECK(s.getValue(PT("B1")) == 10);
+    CHECK(s.getValue(PT("B99")) == 200);
+}
+
+TEST_CASE( "Fill formula from text", "[sheet-copy-move]" ) {
+
+    Sheet s;
+    for (SizeType y = 0; y < 100; ++y)
+        s.setValueCell(Point{0, y}, y + 1);
+    s.setFormulaCell(PT("B5"), "{1;2;3}");
+    s.setFormulaCell(PT("B20"), "7");
+    s.setValueCell(PT("B30"), 8);
+    CHECK(s.getValue(PT("B7")) == 3);
+
+    s.fillFormula(AREA("B1:B100"), "A1 * 2", PT("B1"));
+    CHECK(s.getFormulaInfo(PT("B50")) == Sheet::FormulaInfo{SPRS("A50 * 2"), Spreader::Size{1, 1}});
+    CHECK(s.getValue(PT("B5")) == 10);
+    CHECK(s.getValue(PT("B7")) == 14);
+    CHECK(s.getValue(PT("B20")) == 40);
+    CHECK(s.getValue(PT("B30")) == 60);
+    CHECK(s.nonNullCellCount() == 200);
+
+    s.setValueCell(PT("A50"), 1000);
+    CHECK(s.getValue(PT("B49")) == 98);
+    CHECK(s.getValue(PT("B50")) == 2000);
+
+    //the anchor does not have to be in the filled area
+    s.fillFormula(AREA("C1:D10"), "SUM($A$1:F2)", PT("H1"));
+    CHECK(s.getFormulaInfo(PT("C1")) == Sheet::FormulaInfo{SPRS("SUM($A$1:A2)"), Spreader::Size{1, 1}});
+    CHECK(s.getValue(PT("C1")) == 3);
+    CHECK(s.getValue(PT("D10")) == 66 * 3);
+    s.setValueCell(PT("A11"), 0);
+    CHECK(s.getValue(PT("D10")) == 55 * 3);
+
+    //references that become invalid in part of the area
+    s.fillFormula(AREA("E1:E3"), "A1 + 1", PT("E2"));
+    CHECK(s.getFormulaInfo(PT("E1")) == Sheet::FormulaInfo{SPRS("#REF! + 1"), Spreader::Size{1, 1}});
+    CHECK(s.getValue(PT("E1")) == Error::InvalidReference);
+    CHECK(s.getValue(PT("E2")) == 2);
+    CHECK(s.getValue(PT("E3")) == 3);
+
+    s.fillFormula(AREA("F1:G2"), "ROW() + COLUMN()", PT("A1"));
+    CHECK(s.getValue(PT("G2")) == 9);
+}
+
 TEST_CASE( "Move single cell", "[sheet-copy-move]" ) {
     
     {
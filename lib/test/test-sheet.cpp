@@ -3,6 +3,9 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <limits>
+#include <sstream>
+
 using namespace Spreader;
 
 
@@ -196,6 +199,510 @@ TEST_CASE( "Clearing cells", "[sheet]" ) {
 } 
 
 
+TEST_CASE( "Incremental recalc", "[sheet]" ) {
+
+    SECTION("Chains and ranges") {
+        Sheet s;
+
+        s.setValueCell(PT("A1"), 1.);
+        s.setFormulaCell(PT("B1"), SPRS("A1 * 2"));
+        s.setFormulaCell(PT("C1"), SPRS("B1 + 1"));
+        s.setFormulaCell(PT("D1"), SPRS("SUM(A1:C1)"));
+        s.setFormulaCell(PT("E1"), SPRS("SUM(A:A)"));
+        CHECK(s.getValue(PT("D1")) == 6.);
+        CHECK(s.getValue(PT("E1")) == 1.);
+
+        s.setValueCell(PT("A1"), 2.);
+        CHECK(s.getValue(PT("B1")) == 4.);
+        CHECK(s.getValue(PT("C1")) == 5.);
+        CHECK(s.getValue(PT("D1")) == 11.);
+        CHECK(s.getValue(PT("E1")) == 2.);
+
+        s.setValueCell(PT("A1000"), 3.);
+        CHECK(s.getValue(PT("D1")) == 11.);
+        CHECK(s.getValue(PT("E1")) == 5.);
+
+        s.copyCell(PT("C1"), AREA("C2"));
+        CHECK(s.getValue(PT("C2")) == 1.);
+        s.setValueCell(PT("B2"), 7.);
+        CHECK(s.getValue(PT("C2")) == 8.);
+
+        s.moveCell(PT("C2"), PT("F2"));
+        CHECK(s.getValue(PT("F2")) == 8.);
+        s.setValueCell(PT("B2"), 9.);
+        CHECK(s.getValue(PT("F2")) == 10.);
+
+        s.clearCell(PT("A1"));
+        CHECK(s.getValue(PT("C1")) == 1.);
+        CHECK(s.getValue(PT("D1")) == 1.);
+        CHECK(s.getValue(PT("E1")) == 3.);
+    }
+
+    SECTION("Spills") {
+        Sheet s;
+
+        s.setValueCell(PT("A1"), 1.);
+        s.setValueCell(PT("A2"), 2.);
+        s.setValueCell(PT("A3"), 3.);
+        s.setFormulaCell(PT("C1"), SPRS("A1:A2 + 1"));
+        s.setFormulaCell(PT("D1"), SPRS("C3"));
+        s.setFormulaCell(PT("E1"), SPRS("C2"));
+        CHECK(s.getValue(PT("D1")) == Scalar::Blank{});
+        CHECK(s.getValue(PT("E1")) == 3.);
+
+        s.setFormulaCell(PT("C1"), SPRS("A1:A3 + 1"));
+        CHECK(s.getValue(PT("D1")) == 4.);
+
+        s.setValueCell(PT("A2"), 5.);
+        CHECK(s.getValue(PT("E1")) == 6.);
+
+        s.setValueCell(PT("C2"), SPRS("x"));
+        CHECK(s.getValue(PT("C1")) == Error::Spill);
+        CHECK(s.getValue(PT("D1")) == Scalar::Blank{});
+        CHECK(s.getValue(PT("E1")) == SPRS("x"));
+
+        s.clearCell(PT("C2"));
+        CHECK(s.getValue(PT("C1")) == 2.);
+        CHECK(s.getValue(PT("D1")) == 4.);
+        CHECK(s.getValue(PT("E1")) == 6.);
+    }
+
+    SECTION("Breaking a cycle") {
+        Sheet s;
+
+        s.setFormulaCell(PT("A1"), SPRS("B1"));
+        s.setFormulaCell(PT("B1"), SPRS("A1"));
+        s.setFormulaCell(PT("C1"), SPRS("A1 + 1"));
+        CHECK(s.getValue(PT("A1")) == Error::InvalidReference);
+        CHECK(s.getValue(PT("B1")) == Error::InvalidReference);
+        CHECK(s.getValue(PT("C1")) == Error::InvalidReference);
+
+        s.setValueCell(PT("B1"), 5.);
+        CHECK(s.getValue(PT("A1")) == 5.);
+        CHECK(s.getValue(PT("C1")) == 6.);
+    }
+}
+
+TEST_CASE( "Dependencies calculated later", "[sheet]" ) {
+
+    SECTION("Reverse chain") {
+        Sheet s;
+
+        s.suspendRecalc();
+        s.setFormulaCell(PT("A1"), SPRS("A2 + 1"));
+        s.copyCell(PT("A1"), AREA("A2:A9999"));
+        s.setValueCell(PT("A10000"), 1.);
+        s.resumeRecalc();
+        CHECK(s.getValue(PT("A1")) == 10000.);
+        CHECK(s.getValue(PT("A5000")) == 5001.);
+
+        s.setValueCell(PT("A10000"), 2.);
+        CHECK(s.getValue(PT("A1")) == 10001.);
+    }
+
+    SECTION("Paused aggregators") {
+        Sheet s;
+
+        s.suspendRecalc();
+        s.setFormulaCell(PT("A1"), SPRS("SUM(B1:B5) * 100 + MAX(B1:B5) * 10 + VLOOKUP(3, B1:C5, 2, FALSE)"));
+        s.setFormulaCell(PT("A2"), SPRS("B1:B5 + C1:C5"));
+        for (SizeType y = 0; y < 5; ++y) {
+            s.setFormulaCell(Point{1, y}, s.indexToColumn(3) + s.indexToRow(y) + SPRS(" + 1"));
+            s.setFormulaCell(Point{2, y}, s.indexToColumn(1) + s.indexToRow(y) + SPRS(" * 2"));
+            s.setValueCell(Point{3, y}, double(y));
+        }
+        s.resumeRecalc();
+        CHECK(s.getValue(PT("A1")) == 1500. + 50. + 6.);
+        CHECK(s.getValue(PT("A2")) == 3.);
+        CHECK(s.getValue(PT("A6")) == 15.);
+
+        s.setValueCell(PT("D5"), 9.);
+        CHECK(s.getValue(PT("A1")) == 2000. + 100. + 6.);
+        CHECK(s.getValue(PT("A6")) == 30.);
+    }
+}
+
+TEST_CASE( "Compiled formulas", "[sheet]" ) {
+
+    Sheet s;
+
+    s.setValueCell(PT("A1"), 2.);
+    s.setValueCell(PT("A2"), SPRS("3"));
+    s.setFormulaCell(PT("B1"), SPRS("-A1 * (A2 + 1) ^ 2 & \"x\""));
+    CHECK(s.getValue(PT("B1")) == SPRS("-32x"));
+    s.setFormulaCell(PT("B2"), SPRS("IF(A1 > 1, CHOOSE(A1, A2, A1 + A2, 7), 1/0)"));
+    CHECK(s.getValue(PT("B2")) == 5.);
+    s.setFormulaCell(PT("B3"), SPRS("IF(A3, 1, 2) + CHOOSE(A1 * 2, 1, 2) + B2"));
+    CHECK(s.getValue(PT("B3")) == Error::InvalidValue);
+    s.setFormulaCell(PT("B4"), SPRS("IF(#N/A, 1, 2) & CHOOSE(\"a\", 1)"));
+    CHECK(s.getValue(PT("B4")) == Error::InvalidArgs);
+    s.setFormulaCell(PT("B5"), SPRS("IF(B1 = \"-16x\", SUM(A1:A2), A1%)"));
+    CHECK(s.getValue(PT("B5")) == 0.02);
+
+    s.setValueCell(PT("A1"), 1.);
+    CHECK(s.getValue(PT("B1")) == SPRS("-16x"));
+    CHECK(s.getValue(PT("B2")) == Error::DivisionByZero);
+    CHECK(s.getValue(PT("B3")) == Error::DivisionByZero);
+    CHECK(s.getValue(PT("B5")) == 1.);
+
+    s.deleteRows(0, 1);
+    CHECK(s.getValue(PT("B1")) == Error::InvalidReference);
+    CHECK(s.getFormulaInfo(PT("B2"))->text == SPRS("IF(A2, 1, 2) + CHOOSE(#REF! * 2, 1, 2) + B1"));
+    CHECK(s.getValue(PT("B2")) == Error::InvalidReference);
+}
+
+TEST_CASE( "Formula cache", "[sheet]" ) {
+
+    Sheet s;
+
+    s.suspendRecalc();
+    for (SizeType y = 0; y < 10; ++y) {
+        s.setValueCell(Point{0, y}, double(y));
+        s.setFormulaCell(Point{1, y}, SPRS("A") + s.indexToRow(y) + SPRS(" * 2 + $A$1 + SUM(") + s.indexToRow(y + 20) + SPRS(":") + s.indexToRow(y + 20) + SPRS(")"));
+    }
+    s.resumeRecalc();
+    CHECK(s.formulaCacheStatistics().misses == 1);
+    CHECK(s.formulaCacheStatistics().hits == 9);
+    CHECK(s.getValue(PT("B1")) == 0.);
+    CHECK(s.getValue(PT("B10")) == 18.);
+    CHECK(s.getFormulaInfo(PT("B5"))->text == SPRS("A5 * 2 + $A$1 + SUM(25:25)"));
+
+    //row tokens that are numbers are not relative
+    s.setFormulaCell(PT("C1"), SPRS("1 + A1"));
+    s.setFormulaCell(PT("C2"), SPRS("2 + A2"));
+    s.setFormulaCell(PT("C3"), SPRS("1 + A3"));
+    CHECK(s.formulaCacheStatistics().misses == 3);
+    CHECK(s.formulaCacheStatistics().hits == 10);
+    CHECK(s.getValue(PT("C2")) == 3.);
+    CHECK(s.getValue(PT("C3")) == 3.);
+
+    s.setFormulaCell(PT("D1"), SPRS("A1 +"));
+    s.setFormulaCell(PT("D2"), SPRS("A2 +"));
+    CHECK(s.formulaCacheStatistics().misses == 5);
+    CHECK(s.getFormulaInfo(PT("D2"))->text == SPRS("A2 +"));
+    CHECK(s.getValue(PT("D2")) == Error::InvalidFormula);
+}
+
+TEST_CASE( "Changing value types", "[sheet]" ) {
+
+    Sheet s;
+    s.setFormulaCell(PT("B1"), SPRS("A1&\"!\""));
+    s.setValueCell(PT("A1"), SPRS("a"));
+    CHECK(s.getValue(PT("B1")) == SPRS("a!"));
+    s.setValueCell(PT("A1"), 2.);
+    CHECK(s.getValue(PT("B1")) == SPRS("2!"));
+    s.setValueCell(PT("A1"), true);
+    CHECK(s.getValue(PT("B1")) == SPRS("TRUE!"));
+    s.setValueCell(PT("A1"), SPRS("b"));
+    CHECK(s.getValue(PT("B1")) == SPRS("b!"));
+    s.setValueCell(PT("A1"), Error::InvalidName);
+    CHECK(s.getValue(PT("B1")) == Error::InvalidName);
+
+    s.copyCell(PT("A1"), Rect{PT("A2"), Size{1, 2}});
+    CHECK(s.getValue(PT("A3")) == Error::InvalidName);
+    s.moveCell(PT("A3"), PT("C3"));
+    CHECK(s.getValue(PT("A3")) == Scalar());
+    CHECK(s.getValue(PT("C3")) == Error::InvalidName);
+    CHECK(s.nonNullCellCount() == 4);
+}
+
+TEST_CASE( "Sparse ranges", "[sheet]" ) {
+
+    Sheet s;
+
+    s.setValueCell(PT("A1"), 1.);
+    s.setFormulaCell(PT("A1000"), SPRS("A1 + 1"));
+    s.setValueCell(PT("A100000"), 3.);
+    s.setValueCell(PT("B1"), SPRS("b"));
+    s.setValueCell(PT("A2"), SPRS("c"));
+    s.setValueCell(PT("B1000"), SPRS("two"));
+
+    s.setFormulaCell(PT("D1"), SPRS("SUM(A:A)"));
+    s.setFormulaCell(PT("D2"), SPRS("COUNT(A:A)"));
+    s.setFormulaCell(PT("D3"), SPRS("COUNTA(A:B)"));
+    s.setFormulaCell(PT("D4"), SPRS("CONCAT(A1:B2)"));
+    s.setFormulaCell(PT("D5"), SPRS("SUMIF(A:A, \">1\")"));
+    s.setFormulaCell(PT("D6"), SPRS("MATCH(2, A:A, 0)"));
+    s.setFormulaCell(PT("D7"), SPRS("MATCH(0, A:A, 0)"));
+    s.setFormulaCell(PT("D8"), SPRS("MATCH(4, A:A, 0)"));
+    s.setFormulaCell(PT("D9"), SPRS("VLOOKUP(2, A:B, 2, FALSE)"));
+
+    CHECK(s.getValue(PT("D1")) == 6.);
+    CHECK(s.getValue(PT("D2")) == 3.);
+    CHECK(s.getValue(PT("D3")) == 6.);
+    CHECK(s.getValue(PT("D4")) == SPRS("1bc"));
+    CHECK(s.getValue(PT("D5")) == 5.);
+    CHECK(s.getValue(PT("D6")) == 1000.);
+    CHECK(s.getValue(PT("D7")) == 3.);
+    CHECK(s.getValue(PT("D8")) == Error::InvalidArgs);
+    CHECK(s.getValue(PT("D9")) == SPRS("two"));
+
+    s.setValueCell(PT("A1"), 5.);
+    CHECK(s.getValue(PT("D1")) == 14.);
+    CHECK(s.getValue(PT("D6")) == Error::InvalidArgs);
+}
+
+TEST_CASE( "Numeric blocks", "[sheet]" ) {
+
+    //Runs of numbers are aggregated in blocks. Results must be the same as adding values one by one.
+    Sheet s;
+    Numeric::KahanBabushkaKleinSum<double> sum;
+    Numeric::OnlineAverage<double> average;
+    Numeric::OnlineAverage<double> averageA;
+    Numeric::OnlineStdDev<double, true> stdDev;
+    Numeric::Max<double> max;
+    Numeric::Min<double> min;
+    unsigned count = 0;
+
+    uint64_t seed = 12345;
+    for (SizeType y = 0; y < 3000; ++y) {
+        if (y % 700 == 699) {
+            s.setValueCell(Point{0, y}, SPRS("x"));
+            averageA.add(0);
+        } else if (y % 900 == 899) {
+            s.setValueCell(Point{0, y}, true);
+            averageA.add(1);
+        } else if (y % 500 != 499) {
+            seed = seed * 6364136223846793005u + 1442695040888963407u;
+            double value = double(int64_t(seed >> 33) % 2'000'000) / 1000 - 1000;
+            s.setValueCell(Point{0, y}, value);
+            for (auto * aggr: {&average, &averageA})
+                aggr->add(value);
+            sum.add(value);
+            stdDev.add(value);
+            max.add(value);
+            min.add(value);
+            ++count;
+        }
+    }
+    s.setFormulaCell(PT("B1"), SPRS("SUM(A:A)"));
+    s.setFormulaCell(PT("B2"), SPRS("AVERAGE(A:A)"));
+    s.setFormulaCell(PT("B3"), SPRS("AVERAGEA(A:A)"));
+    s.setFormulaCell(PT("B4"), SPRS("STDEV(A:A)"));
+    s.setFormulaCell(PT("B5"), SPRS("MAX(A:A)"));
+    s.setFormulaCell(PT("B6"), SPRS("MIN(A:A)"));
+    s.setFormulaCell(PT("B7"), SPRS("COUNT(A:A)"));
+    CHECK(s.getValue(PT("B1")) == Scalar(sum.value()));
+    CHECK(s.getValue(PT("B2")) == Scalar(average.value()));
+    CHECK(s.getValue(PT("B3")) == Scalar(averageA.value()));
+    CHECK(s.getValue(PT("B4")) == Scalar(stdDev.value()));
+    CHECK(s.getValue(PT("B5")) == Scalar(max.value()));
+    CHECK(s.getValue(PT("B6")) == Scalar(min.value()));
+    CHECK(s.getValue(PT("B7")) == Scalar(count));
+
+    SECTION("signed zeros") {
+        //the first of equal values wins
+        for (SizeType y = 0; y < 16; ++y)
+            s.setValueCell(Point{2, y}, y < 7 ? 1. : (y % 2 ? -0. : 0.));
+        s.setFormulaCell(PT("D1"), SPRS("MIN(C1:C16)"));
+        auto value = s.getValue(PT("D1"));
+        REQUIRE(get<Number>(&value));
+        CHECK(std::signbit(get<Number>(value).value()));
+    }
+}
+
+TEST_CASE( "Cell iteration", "[sheet]" ) {
+
+    Sheet s;
+
+    s.setValueCell(PT("B2"), 1.);
+    s.setValueCell(PT("A3"), SPRS("a"));
+    s.setFormulaCell(PT("C3"), SPRS("{1,2}"));
+    s.setFormulaCell(PT("A5"), SPRS("Z1000"));
+    s.setValueCell(PT("B100000"), 2.);
+
+    std::string buf;
+    auto stringize = [&](Point pt, const Scalar & value, bool isFormula) {
+        std::ostringstream str;
+        str << '[' << pt << ',' << value << ',' << isFormula << ']';
+        buf += str.str();
+    };
+    s.forEachCell(AREA("A1:D100000"), stringize);
+    CHECK(buf == "[{1,1},1,0][{0,2},a,0][{2,2},1,1][{3,2},2,0][{0,4},<empty>,1][{1,99999},2,0]");
+
+    buf.clear();
+    for (auto [pt, value, isFormula]: s.cells(AREA("B1:B100000")))
+        stringize(pt, value, isFormula);
+    CHECK(buf == "[{1,1},1,0][{1,99999},2,0]");
+
+    size_t count = 0;
+    CHECK(!s.forEachCell(AREA("A:D"), [&](Point, const Scalar &, bool) {
+        return ++count < 2;
+    }));
+    CHECK(count == 2);
+}
+
+TEST_CASE( "String pooling", "[sheet]" ) {
+
+    Sheet s;
+
+    CHECK(!s.stringPoolStatistics());
+
+    s.setStringPooling(true);
+    for (SizeType y = 0; y < 100; ++y)
+        s.setValueCell(Point{0, y}, String(std::string(y % 2 ? "odd" : "even")));
+    auto stats = s.stringPoolStatistics();
+    REQUIRE(stats);
+    CHECK(stats->distinctCount == 2);
+    CHECK(stats->sharedCount == 98);
+    CHECK(stats->savedSize == (49 * 3 + 49 * 4) * sizeof(String::storage_type));
+    CHECK(s.getValue(PT("A1")) == SPRS("even"));
+    CHECK(s.getValue(PT("A2")) == SPRS("odd"));
+
+    s.setFormulaCell(PT("B1"), SPRS("A1 & \"!\""));
+    s.copyCell(PT("B1"), AREA("B2:B100"));
+    stats = s.stringPoolStatistics();
+    REQUIRE(stats);
+    CHECK(stats->distinctCount == 4);
+    CHECK(stats->sharedCount == 98 + 98);
+    CHECK(s.getValue(PT("B3")) == SPRS("even!"));
+    CHECK(s.getValue(PT("B4")) == SPRS("odd!"));
+
+    s.setStringPooling(false);
+    CHECK(!s.stringPoolStatistics());
+    s.setValueCell(PT("A1"), SPRS("odd"));
+    CHECK(s.getValue(PT("B1")) == SPRS("odd!"));
+}
+
+TEST_CASE( "String pool purging", "[sheet]" ) {
+
+    Sheet s;
+    s.setStringPooling(true);
+    s.setFormulaCell(PT("B1"), SPRS("A1 & \"x\""));
+    s.setValueCell(PT("C1"), SPRS("kept"));
+
+    size_t maxDistinctCount = 0;
+    for (int i = 0; i < 10000; ++i) {
+        s.setValueCell(PT("A1"), double(i));
+        maxDistinctCount = std::max(maxDistinctCount, s.stringPoolStatistics()->distinctCount);
+    }
+    CHECK(maxDistinctCount <= 1024);
+    CHECK(s.getValue(PT("B1")) == SPRS("9999x"));
+    
+    s.setValueCell(PT("D1"), String(std::string("kept")));
+    CHECK(s.stringPoolStatistics()->sharedCount == 1);
+}
+
+#if !SPR_SINGLE_THREADED
+TEST_CASE( "Concurrent recalc", "[sheet]" ) {
+
+    constexpr SizeType Height = 1000;
+
+    Sheet s;
+    s.setRecalcThreadCount(4);
+
+    s.suspendRecalc();
+    s.setValueCell(PT("A1"), 1.);
+    s.setFormulaCell(PT("B1"), SPRS("A1 * 2"));
+    s.setFormulaCell(PT("C1"), SPRS("B1 + A1"));
+    s.copyCells(AREA("A1:C1"), PT("A2"));
+    s.copyCells(AREA("A1:C2"), PT("A3"));
+    s.copyCells(AREA("A1:C4"), PT("A5"));
+    for (SizeType y = 8; y < Height; y *= 2)
+        s.copyCells(Spreader::Rect{{0, 0}, {3, y}}, Point{0, y});
+    s.setFormulaCell(PT("D1"), SPRS("SUM(C:C)"));
+    s.setFormulaCell(PT("E1"), SPRS("C1:C2"));
+    s.resumeRecalc();
+
+    CHECK(s.getValue(Point{2, Height - 1}) == 3.);
+    CHECK(s.getValue(PT("D1")) == 3. * 1024);
+    CHECK(s.getValue(PT("E2")) == 3.);
+
+    s.setValueCell(PT("A2"), 2.);
+    CHECK(s.getValue(PT("C2")) == 6.);
+    CHECK(s.getValue(PT("D1")) == 3. * 1024 + 3.);
+    CHECK(s.getValue(PT("E2")) == 6.);
+
+    s.suspendRecalc();
+    for (SizeType y = 0; y < Height; ++y)
+        s.setValueCell(Point{0, y}, double(y));
+    s.resumeRecalc();
+    for (SizeType y = 0; y < Height; ++y)
+        REQUIRE(s.getValue(Point{2, y}) == 3. * y);
+}
+#endif
+
+TEST_CASE( "Bulk values", "[sheet]" ) {
+
+    Sheet s;
+
+    s.setFormulaCell(PT("D1"), "SUM(A1:C2)");
+    s.setFormulaCell(PT("B2"), "7");
+    s.setValueCell(PT("C2"), 100);
+
+    Scalar values[] = {1, SPRS("a"), true, Scalar(), 2, Error::InvalidValue};
+    s.setValueCells(AREA("A1:C2"), values);
+    CHECK(s.getValue(PT("A1")) == 1);
+    CHECK(s.getValue(PT("B1")) == SPRS("a"));
+    CHECK(s.getValue(PT("C1")) == true);
+    CHECK(s.getValue(PT("A2")) == Scalar());
+    CHECK(s.getValue(PT("B2")) == 2);
+    CHECK(!s.getFormulaInfo(PT("B2")));
+    CHECK(s.getValue(PT("C2")) == Error::InvalidValue);
+    CHECK(s.getValue(PT("D1")) == Error::InvalidValue);
+    CHECK(s.nonNullCellCount() == 6);
+
+    double numbers[] = {1, 2, 3, 4, std::numeric_limits<double>::infinity(), 6};
+    s.setValueCells(AREA("A1:C2"), numbers);
+    CHECK(s.getValue(PT("B1")) == 2);
+    CHECK(s.getValue(PT("A2")) == 4);
+    CHECK(s.getValue(PT("D1")) == Error::NotANumber);
+    CHECK(s.nonNullCellCount() == 7);
+
+    s.setStringPooling(true);
+    String strings[] = {String(std::string("x")), String(std::string("y"))};
+    s.setValueCells(AREA("A1:A2"), strings);
+    String otherStrings[] = {String(std::string("x")), String(std::string("y"))};
+    s.setValueCells(AREA("B1:B2"), otherStrings);
+    CHECK(s.getValue(PT("A2")) == SPRS("y"));
+    CHECK(s.getValue(PT("B1")) == SPRS("x"));
+    CHECK(s.stringPoolStatistics()->sharedCount == 2);
+    CHECK(s.getValue(PT("D1")) == 9);
+    s.setValueCells(AREA("C2:C2"), std::span<const double>(numbers, 1));
+    CHECK(s.getValue(PT("D1")) == 4);
+
+    //large enough to span several leaf tiles
+    std::vector<double> column(100000);
+    for (size_t i = 0; i < column.size(); ++i)
+        column[i] = double(i);
+    s.setFormulaCell(PT("E1"), "SUM(F:F)");
+    s.setValueCells(Rect{.origin = {5, 10}, .size = {1, SizeType(column.size())}}, column);
+    CHECK(s.getValue(PT("E1")) == double(column.size()) * (column.size() - 1) / 2);
+    CHECK(s.getValue({5, 10 + 1234}) == 1234);
+    CHECK(s.size().height == 10 + column.size());
+}
+
+TEST_CASE( "Bulk reads", "[sheet]" ) {
+
+    Sheet s;
+
+    s.setValueCell(PT("A1"), 1.5);
+    s.setValueCell(PT("B1"), SPRS("a"));
+    s.setValueCell(PT("C1"), false);
+    s.setValueCell(PT("A2"), Error::InvalidName);
+    s.setFormulaCell(PT("B2"), "{\"b\";\"c\"}");
+
+    using Type = Sheet::ValueType;
+
+    std::vector<double> numbers(12, -1);
+    std::vector<Type> types(12, Type::Number);
+    std::vector<String> strings{SPRS("x")};
+    s.getValues(AREA("A1:D3"), numbers, types, strings);
+    CHECK(types == std::vector<Type>{Type::Number, Type::String, Type::Bool,   Type::Blank, 
+                                     Type::Error,  Type::String, Type::Blank,  Type::Blank, 
+                                     Type::Blank,  Type::String, Type::Blank,  Type::Blank});
+    CHECK(numbers == std::vector<double>{1.5, 1, 0, 0, 
+                                         double(Error::InvalidName), 2, 0, 0, 
+                                         0, 3, 0, 0});
+    CHECK(strings == std::vector<String>{SPRS("x"), SPRS("a"), SPRS("b"), SPRS("c")});
+
+    numbers.resize(2);
+    types.resize(2);
+    s.getValues(Rect{.origin = {100, 100}, .size = {1, 2}}, numbers, types, strings);
+    CHECK(types == std::vector<Type>{Type::Blank, Type::Blank});
+    CHECK(numbers == std::vector<double>{0, 0});
+    CHECK(strings.size() == 4);
+}
 
 #ifdef NDEBUG
 TEST_CASE( "Speed test", "[sheet]" ) {
@@ -226,6 +733,50 @@ TEST_CASE( "Speed test", "[sheet]" ) {
     }
 }
 
+TEST_CASE( "Reverse chain speed test", "[sheet]" ) {
+
+    constexpr SizeType Height = 1000000;
+
+    Sheet s;
+    {
+        double beg = clock();
+        s.setFormulaCell(PT("A1"), "A2 + 1");
+        s.copyCell(PT("A1"), Spreader::Rect{.origin = {0, 1}, .size = {1, Height - 2}});
+        s.setValueCell({0, Height - 1}, 1.);
+        double end = clock();
+        printf("time: %lf\n", (end - beg) / CLOCKS_PER_SEC);
+        CHECK(s.getValue(PT("A1")) == double(Height));
+    }
+}
+
+TEST_CASE( "Bulk value speed test", "[sheet]" ) {
+
+    constexpr SizeType Width = 100;
+    constexpr SizeType Height = 100000;
+
+    std::vector<double> values(size_t(Width) * Height, 1.);
+
+    Sheet s;
+    s.setFormulaCell(PT("A1"), "SUM(B:CW)");
+    {
+        double beg = clock();
+        s.setValueCells(Spreader::Rect{.origin = {1, 0}, .size = {Width, Height}}, values);
+        double end = clock();
+        printf("time: %lf\n", (end - beg) / CLOCKS_PER_SEC);
+        CHECK(s.getValue(PT("A1")) == double(values.size()));
+    }
+    {
+        std::vector<double> numbers(values.size());
+        std::vector<Sheet::ValueType> types(values.size());
+        std::vector<String> strings;
+        double beg = clock();
+        s.getValues(Spreader::Rect{.origin = {1, 0}, .size = {Width, Height}}, numbers, types, strings);
+        double end = clock();
+        printf("time: %lf\n", (end - beg) / CLOCKS_PER_SEC);
+        CHECK(numbers == values);
+    }
+}
+
 TEST_CASE( "Array speed test", "[sheet]" ) {
     
     constexpr SizeType Width = 1000;
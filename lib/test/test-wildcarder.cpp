@@ -110,3 +110,38 @@ TEST_CASE( "Escaping", "[wildcarder]" ) {
     CHECK( wc.match("a*~", "a~qqqq~"));
     
 }
+
+TEST_CASE( "Compiled pattern", "[wildcarder]" ) {
+    
+    Wildcarder wc('~');
+    
+    const char * patterns[] = {
+        "", "a", "ab", "?", "a?", "?a", "a?b", "a??b", "*", "**", "*a", "a*", "*a*", "a*b", "a**b", "*ab*",
+        "a*b*c", "*a?b*", "?*?", "*?a", "a*?", "ab*ab", "*aba*aba*", "~", "~~", "~q", "~?", "~*", "a~*b", 
+        "a*~", "?~??", "a~"
+    };
+    const char * texts[] = {
+        "", "a", "b", "ab", "ba", "aa", "abc", "acb", "abab", "aab", "abb", "abbbbb", "bcab", "aqb", "aqqb",
+        "abcabc", "xabay", "ababa", "abaaba", "abababa", "~", "~~", "~q", "q", "?", "??", "*", "a*b", "ab*",
+        "a~qqqq~", "?q?", "a~"
+    };
+    
+    for (auto pattern: patterns) {
+        std::string_view patternView(pattern);
+        WildcardPattern<char> compiled(patternView, '~');
+        for (auto text: texts) {
+            INFO("pattern: \"" << pattern << "\", text: \"" << text << '"');
+            std::string_view view(text);
+            bool expected = wc.match(patternView.data(), patternView.data() + patternView.size(), 
+                                     view.data(), view.data() + view.size());
+            CHECK(compiled.match(view) == expected);
+            CHECK(compiled.match(view.begin(), view.end()) == compiled.match(view.data(), view.data() + view.size()));
+        }
+    }
+    
+    //escapes after a star
+    CHECK( WildcardPattern<char>(std::string_view("*~*"), '~').match(std::string_view("a*")));
+    CHECK(!WildcardPattern<char>(std::string_view("*~*"), '~').match(std::string_view("a*b")));
+    CHECK( WildcardPattern<char>(std::string_view("*~x"), '~').match(std::string_view("a~x")));
+    CHECK(!WildcardPattern<char>(std::string_view("*~x"), '~').match(std::string_view("~ax")));
+}
@@ -37,3 +37,43 @@ TEST_CASE( "Number matcher", "[scalar-xif-matcher]" ) {
     CHECK(!matcher(Error::DivisionByZero));
     CHECK( matcher(0));
 }
+
+TEST_CASE( "String matcher", "[scalar-xif-matcher]" ) {
+
+    {
+        XIfMatcher matcher(SPRS("a?c*"));
+
+        CHECK( matcher(SPRS("abc")));
+        CHECK( matcher(SPRS("AbCdef")));
+        CHECK( matcher(SPRS("axcé")));
+        CHECK(!matcher(SPRS("ab")));
+        CHECK(!matcher(SPRS("éabc")));
+        CHECK(!matcher(Scalar()));
+    }
+    {
+        XIfMatcher matcher(SPRS("é*"));
+
+        CHECK( matcher(SPRS("é")));
+        CHECK( matcher(SPRS("Éa")));
+        CHECK(!matcher(SPRS("e")));
+    }
+    {
+        XIfMatcher matcher(SPRS("<b"));
+
+        CHECK( matcher(SPRS("a")));
+        CHECK( matcher(SPRS("A")));
+        CHECK( matcher(SPRS("aZZ")));
+        CHECK(!matcher(SPRS("b")));
+        CHECK(!matcher(SPRS("B")));
+        CHECK(!matcher(SPRS("é")));
+        CHECK(!matcher(1));
+    }
+    {
+        XIfMatcher matcher(SPRS(">=é"));
+
+        CHECK( matcher(SPRS("É")));
+        CHECK( matcher(SPRS("éa")));
+        CHECK(!matcher(SPRS("z")));
+        CHECK(!matcher(SPRS("Z")));
+    }
+}
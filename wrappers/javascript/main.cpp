@@ -6,6 +6,8 @@
 #include <emscripten.h>
 #include <emscripten/val.h>
 
+#include <vector>
+
 using namespace Spreader;
 using namespace emscripten;
 
@@ -169,6 +171,49 @@ extern "C" {
         }, self->getValue({x, y}));
     }
 
+    EMSCRIPTEN_KEEPALIVE void sheetSetValueCellsDouble(Sheet * self, 
+                                                       SizeType x, SizeType y, SizeType width, SizeType height,
+                                                       EM_VAL values) { 
+        if (!self) SPR_FATAL_ERROR("null sheet handle");
+        
+        std::vector<double> numbers(size_t(width) * height);
+        EM_ASM({
+            HEAPF64.set(Emval.toValue($0), $1 >> 3);
+        }, values, numbers.data());
+        self->setValueCells({.origin = {x, y}, .size = {width, height}}, std::span<const double>(numbers));
+    }
+
+    EMSCRIPTEN_KEEPALIVE auto sheetGetValues(const Sheet * self, 
+                                             SizeType x, SizeType y, SizeType width, SizeType height) -> EM_VAL {
+        if (!self) SPR_FATAL_ERROR("null sheet handle");
+
+        const size_t count = size_t(width) * height;
+        std::vector<double> numbers(count);
+        std::vector<Sheet::ValueType> types(count);
+        std::vector<String> strings;
+        self->getValues({.origin = {x, y}, .size = {width, height}}, numbers, types, strings);
+
+        //All strings are packed into a single UTF-16 buffer. String i occupies [offsets[i], offsets[i + 1])
+        std::vector<char16_t> chars;
+        std::vector<uint32_t> offsets;
+        offsets.reserve(strings.size() + 1);
+        for (auto & str: strings) {
+            offsets.push_back(uint32_t(chars.size()));
+            String::utf16_view view(str);
+            chars.insert(chars.end(), view.begin(), view.end());
+        }
+        offsets.push_back(uint32_t(chars.size()));
+
+        return (EM_VAL)EM_ASM_PTR({
+            return Emval.toHandle({
+                numbers: HEAPF64.slice($0 >> 3, ($0 >> 3) + $1),
+                types: HEAPU8.slice($2, $2 + $1),
+                chars: HEAPU16.slice($3 >> 1, ($3 >> 1) + $4),
+                offsets: HEAPU32.slice($5 >> 2, ($5 >> 2) + $6)
+            });
+        }, numbers.data(), count, types.data(), chars.data(), chars.size(), offsets.data(), offsets.size());
+    }
+
     EMSCRIPTEN_KEEPALIVE auto sheetGetEditInfo(const Sheet * self, SizeType x, SizeType y) -> EM_VAL {
         if (!self) SPR_FATAL_ERROR("null sheet handle");
         auto maybeInfo = self->getFormulaInfo({x, y});
@@ -173,6 +173,61 @@ declare namespace Spreader {
         static InvalidFormula: ErrorValue;
     }
 
+    /**
+     * Type of each cell value in {@link Values}
+     */
+    const ValueType: {
+        readonly Blank: 0;
+        readonly Bool: 1;
+        readonly Number: 2;
+        readonly String: 3;
+        readonly Error: 4;
+    };
+
+    /**
+     * Values of all cells in an area, as returned by {@link Sheet.getValues}
+     * 
+     * The values are stored in typed arrays in row-major order so that
+     * reading a large area requires only a single call into WebAssembly. 
+     * For the cell at index `i`:
+     * - `types[i]` is one of {@link ValueType} values
+     * - `numbers[i]` is the number itself for numbers, 1 or 0 for booleans, 
+     *   the error code for errors and the index of the string for strings.
+     * 
+     * All strings are packed into `chars` as UTF-16. String `n` occupies
+     * `chars[offsets[n]]` up to but not including `chars[offsets[n + 1]]`.
+     * 
+     * If you only need numbers you can use `numbers` and `types` directly without
+     * creating any per-cell objects.
+     */
+    class Values {
+        /** Size of the area */
+        size: Size;
+        numbers: Float64Array;
+        types: Uint8Array;
+        chars: Uint16Array;
+        offsets: Uint32Array;
+
+        /**
+         * Decodes a string from the packed buffer
+         * @param idx index of the string, i.e. the `numbers` entry of a string cell
+         */
+        string(idx: number): string;
+
+        /**
+         * Returns the value of a cell
+         * @param idx index of the cell in row-major order
+         */
+        get(idx: number): Scalar;
+
+        /**
+         * Returns the value of a cell
+         * @param x column relative to the area origin
+         * @param y row relative to the area origin
+         */
+        getAt(x: number, y: number): Scalar;
+    }
+
     /**
      * A spreadsheet
      */
@@ -261,6 +316,28 @@ declare namespace Spreader {
          */
         getValue(coord: CellCoord): Scalar;
 
+        /**
+         * Stores numbers into all cells of an area
+         * 
+         * This is equivalent to calling {@link setValueCell} for each cell
+         * but transfers all the values in a single call.
+         * 
+         * @param area the area to store the numbers into
+         * @param values numbers in row-major order. There must be exactly one 
+         * per cell in `area`. Passing a `Float64Array` avoids a conversion.
+         */
+        setValueCells(area: AreaCoord, values: Float64Array | ArrayLike<number>): void;
+
+        /**
+         * Retrieves values of all cells in an area
+         * 
+         * This is much faster than calling {@link getValue} for each cell when
+         * reading many cells at once, for example, to refresh a grid view.
+         * 
+         * @param area the area to read
+         */
+        getValues(area: AreaCoord): Values;
+
         /**
          * Retrieves information about cell of interest when editing it.
          * 
@@ -487,6 +564,8 @@ declare namespace Spreader {
     class Module {
         
         ErrorValue: typeof ErrorValue;
+        ValueType: typeof ValueType;
+        Values: typeof Values;
         Sheet: typeof Sheet
     }
 }
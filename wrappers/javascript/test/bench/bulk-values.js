@@ -0,0 +1,59 @@
+// @ts-check
+"use strict";
+
+//Compares reading an area cell by cell with reading it via Sheet.getValues
+//Run with: npm run bench
+
+const Spreader = require('spreader')
+const { performance } = require('perf_hooks')
+
+/**
+ * @param {string} name 
+ * @param {() => void} func 
+ */
+function measure(name, func) {
+    const repeat = 20;
+    func();
+    const start = performance.now();
+    for (let i = 0; i < repeat; ++i)
+        func();
+    console.log(`${name}: ${((performance.now() - start) / repeat).toFixed(3)}ms`);
+}
+
+async function main() {
+    const spreader = await Spreader();
+    const s = new spreader.Sheet();
+    try {
+        const width = 100, height = 100;
+        const numbers = new Float64Array(width * height);
+        for (let i = 0; i < numbers.length; ++i)
+            numbers[i] = i;
+        s.setValueCells([0, 0, width, height], numbers);
+        for (let y = 0; y < height; y += 2)
+            s.setValueCell([0, y], "row " + y);
+
+        console.log(`${width * height} cells`);
+        measure('getValue per cell', () => {
+            for (let y = 0; y < height; ++y)
+                for (let x = 0; x < width; ++x)
+                    s.getValue([x, y]);
+        });
+        measure('getValues', () => {
+            const values = s.getValues([0, 0, width, height]);
+            for (let i = 0; i < values.types.length; ++i)
+                values.get(i);
+        });
+        measure('setValueCell per cell', () => {
+            for (let y = 0; y < height; ++y)
+                for (let x = 0; x < width; ++x)
+                    s.setValueCell([x, y], numbers[y * width + x]);
+        });
+        measure('setValueCells', () => {
+            s.setValueCells([0, 0, width, height], numbers);
+        });
+    } finally {
+        s.delete();
+    }
+}
+
+main();
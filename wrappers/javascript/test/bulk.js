@@ -0,0 +1,68 @@
+// @ts-check
+"use strict";
+
+const { runWithSheet } = require('./util')
+const assert = require('assert')
+
+describe('Bulk values', function () {
+
+    it('stores numbers into an area', runWithSheet((s, spreader) => {
+
+        s.setValueCells("A1:C2", [0, 1, 2, 3, 4, 5]);
+        assert.strictEqual(s.nonNullCellCount(), 6n);
+        assert.strictEqual(s.getValue("A1"), 0);
+        assert.strictEqual(s.getValue("C1"), 2);
+        assert.strictEqual(s.getValue("A2"), 3);
+        assert.strictEqual(s.getValue("C2"), 5);
+
+        s.setValueCells([0, 0, 3, 1], new Float64Array([1.5, Infinity, NaN]));
+        assert.strictEqual(s.getValue("A1"), 1.5);
+        assert.strictEqual(s.getValue("B1"), spreader.ErrorValue.NotANumber);
+        assert.strictEqual(s.getValue("C1"), spreader.ErrorValue.NotANumber);
+
+        assert.throws(() => s.setValueCells("A1:C2", [1, 2, 3]), RangeError);
+    }));
+
+    it('reads values of an area', runWithSheet((s, spreader) => {
+
+        s.setValueCell("A1", 1);
+        s.setValueCell("B1", "abc");
+        s.setValueCell("C1", "");
+        s.setValueCell("A2", false);
+        s.setFormulaCell("B2", "1/0");
+        s.setValueCell("C2", "\u{1F600}x");
+
+        const values = s.getValues("A1:D2");
+        assert.deepStrictEqual(values.size, {width: 4, height: 2});
+        assert.deepStrictEqual(Array.from(values.types), [
+            spreader.ValueType.Number, spreader.ValueType.String, spreader.ValueType.String, spreader.ValueType.Blank,
+            spreader.ValueType.Bool,   spreader.ValueType.Error,  spreader.ValueType.String, spreader.ValueType.Blank
+        ]);
+        assert.strictEqual(values.get(0), 1);
+        assert.strictEqual(values.get(1), "abc");
+        assert.strictEqual(values.get(2), "");
+        assert.strictEqual(values.get(3), null);
+        assert.strictEqual(values.getAt(0, 1), false);
+        assert.strictEqual(values.getAt(1, 1), spreader.ErrorValue.DivisionByZero);
+        assert.strictEqual(values.getAt(2, 1), "\u{1F600}x");
+        assert.strictEqual(values.getAt(3, 1), null);
+        assert.strictEqual(values.chars.length, 6);
+        assert.deepStrictEqual(Array.from(values.offsets), [0, 3, 3, 6]);
+    }));
+
+    it('reads the same values as reading cells one by one', runWithSheet((s) => {
+
+        const width = 100, height = 100;
+        const numbers = new Float64Array(width * height);
+        for (let i = 0; i < numbers.length; ++i)
+            numbers[i] = i;
+        s.setValueCells([0, 0, width, height], numbers);
+        s.setValueCell([5, 7], "abc");
+        s.setValueCell([6, 7], null);
+
+        const values = s.getValues([0, 0, width, height]);
+        for (let y = 0; y < height; ++y)
+            for (let x = 0; x < width; ++x)
+                assert.strictEqual(values.getAt(x, y), s.getValue([x, y]));
+    }));
+});
@@ -53,6 +53,10 @@
  * @type { {length?: number, hidden: boolean}}
  */
 
+/**
+ * @typedef {{numbers: Float64Array, types: Uint8Array, chars: Uint16Array, offsets: Uint32Array}} PackedValues
+ */
+
 /**
  * @typedef LengthInfoHandler 
  * @type {(startIdx: number, endIdx: number, info: LengthInfo) => boolean}
@@ -101,6 +105,80 @@ Module['ErrorValue'].Spill            = Object.freeze(new ErrorValue( 9)); //#SP
 Module['ErrorValue'].InvalidFormula   = Object.freeze(new ErrorValue(10)); //#ERROR!
 
 
+//These must match Sheet::ValueType in the C++ library
+const ValueType = Object.freeze({
+    Blank:  0,
+    Bool:   1,
+    Number: 2,
+    String: 3,
+    Error:  4
+});
+
+Module['ValueType'] = ValueType;
+
+/**
+ * @param {Uint16Array} chars 
+ * @returns {string}
+ */
+function decodeUTF16(chars) {
+    //Convert in chunks to stay within the argument count limits of apply
+    const chunkSize = 4096;
+    if (chars.length <= chunkSize)
+        return String.fromCharCode.apply(null, chars);
+    let ret = '';
+    for (let i = 0; i < chars.length; i += chunkSize)
+        ret += String.fromCharCode.apply(null, chars.subarray(i, i + chunkSize));
+    return ret;
+}
+
+class Values {
+
+    /**
+     * @param {Size} size 
+     * @param {PackedValues} packed 
+     */
+    constructor(size, packed) {
+        this.size = size;
+        this.numbers = packed.numbers;
+        this.types = packed.types;
+        this.chars = packed.chars;
+        this.offsets = packed.offsets;
+    }
+
+    /**
+     * @param {number} idx 
+     * @return {string}
+     */
+    string(idx) {
+        return decodeUTF16(this.chars.subarray(this.offsets[idx], this.offsets[idx + 1]));
+    }
+
+    /**
+     * @param {number} idx 
+     * @return {Scalar}
+     */
+    get(idx) {
+        switch(this.types[idx]) {
+            case ValueType.Bool:    return this.numbers[idx] != 0;
+            case ValueType.Number:  return this.numbers[idx];
+            case ValueType.String:  return this.string(this.numbers[idx]);
+            case ValueType.Error:   return ErrorValue.fromCode(this.numbers[idx]);
+        }
+        return null;
+    }
+
+    /**
+     * @param {number} x 
+     * @param {number} y 
+     * @return {Scalar}
+     */
+    getAt(x, y) {
+        return this.get(y * this.size.width + x);
+    }
+}
+
+Module['Values'] = Values;
+
 
 class Sheet {
 
@@ -217,6 +295,38 @@ class Sheet {
         }
     }
 
+    /**
+     * @param {AreaCoord} area 
+     * @param {ArrayLike<number>} values 
+     */
+    setValueCells(area, values) {
+        let rect = this._unpackArea(area);
+        if (values.length !== rect.size.width * rect.size.height)
+            throw new RangeError("values do not match the area size: " + values.length);
+        if (!(values instanceof Float64Array))
+            values = Float64Array.from(values);
+        let val = Emval.toHandle(values);
+        try {
+            _sheetSetValueCellsDouble(this.handle, rect.origin.x, rect.origin.y, rect.size.width, rect.size.height, val);
+        } finally {
+            __emval_decref(val);
+        }
+    }
+
+    /**
+     * @param {AreaCoord} area 
+     * @return {Values}
+     */
+    getValues(area) {
+        let rect = this._unpackArea(area);
+        let ret = _sheetGetValues(this.handle, rect.origin.x, rect.origin.y, rect.size.width, rect.size.height);
+        try {
+            return new Values(rect.size, Emval.toValue(ret));
+        } finally {
+            __emval_decref(ret);
+        }
+    }
+
     /**
      * 
      * @param {CellCoord} coord 
@@ -6,6 +6,8 @@
 #include "arguments.h"
 #include "globals.h"
 
+#include <bit>
+
 
 using namespace Spreader;
 using namespace isptr;
@@ -21,6 +23,45 @@ using namespace isptr;
 
 py_ptr<PyTypeObject> g_errorValueClass;
 
+///A C-contiguous buffer obtained via the buffer protocol
+class ContiguousBuffer {
+public:
+    ContiguousBuffer() noexcept = default;
+    ~ContiguousBuffer() noexcept {
+        if (m_buffer.obj)
+            PyBuffer_Release(&m_buffer);
+    }
+    ContiguousBuffer(const ContiguousBuffer &) = delete;
+    ContiguousBuffer & operator=(const ContiguousBuffer &) = delete;
+
+    auto acquire(PyObject * obj) -> bool {
+        return PyObject_GetBuffer(obj, &m_buffer, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == 0;
+    }
+
+    ///Whether the items are of the given struct module type code in native byte order
+    auto hasFormat(char code, size_t itemSize) const noexcept -> bool {
+        const char * format = m_buffer.format ? m_buffer.format : "B";
+        if (*format == '@' || *format == '=' || (*format == '<' && std::endian::native == std::endian::little))
+            ++format;
+        return format[0] == code && format[1] == 0 && size_t(m_buffer.itemsize) == itemSize;
+    }
+
+    ///Whether the items fill the area in row-major order
+    auto matches(Spreader::Size size) const noexcept -> bool {
+        if (m_buffer.ndim == 2)
+            return size_t(m_buffer.shape[0]) == size_t(size.height) && size_t(m_buffer.shape[1]) == size_t(size.width);
+        return size_t(m_buffer.len / m_buffer.itemsize) == size_t(size.width) * size.height;
+    }
+
+    template<class T>
+    auto items() const noexcept -> std::span<const T> {
+        return {static_cast<const T *>(m_buffer.buf), size_t(m_buffer.len / m_buffer.itemsize)};
+    }
+
+private:
+    Py_buffer m_buffer{};
+};
+
 struct LengthInfoGeneratorObject {
     using GeneratorType = CoroGenerator<std::tuple<SizeType, SizeType, const Sheet::LengthInfo &>>;
 
@@ -213,6 +254,75 @@ public:
         EXTERNAL_EPILOG
     }
 
+    static auto setValues(SheetObject * self, PyObject * args) -> PyObject * {
+        EXTERNAL_PROLOG
+            auto parsedArgs = parseArguments<Typelist<Spreader::Rect, py_ptr<PyObject>>>(args, {"setValues", {{"area"}, {"values"}}});
+            if (!parsedArgs)
+                return nullptr;
+            auto & [area, values] = parsedArgs->values;
+
+            ContiguousBuffer buffer;
+            if (!buffer.acquire(values.get()))
+                return nullptr;
+            if (!buffer.matches(area.size)) {
+                PyErr_SetString(PyExc_ValueError, "values do not match the area size");
+                return nullptr;
+            }
+
+            if (buffer.hasFormat('d', sizeof(double))) {
+                self->sheet.setValueCells(area, buffer.items<double>());
+            } else if (buffer.hasFormat('O', sizeof(PyObject *))) {
+                auto objects = buffer.items<PyObject *>();
+                std::vector<Scalar> scalars;
+                scalars.reserve(objects.size());
+                for (auto obj: objects) {
+                    auto scalar = fromPython<Scalar>(obj, {"value"});
+                    if (!scalar)
+                        return nullptr;
+                    scalars.emplace_back(std::move(*scalar));
+                }
+                self->sheet.setValueCells(area, std::span<const Scalar>(scalars));
+            } else {
+                PyErr_SetString(PyExc_TypeError, "values must be a buffer of doubles or of objects");
+                return nullptr;
+            }
+            Py_RETURN_NONE;
+        EXTERNAL_EPILOG
+    }
+
+    static auto getValues(SheetObject * self, PyObject * args) -> PyObject * {
+        EXTERNAL_PROLOG
+            auto parsedArgs = parseArguments<Typelist<Spreader::Rect>>(args, {"getValues", {{"area"}}});
+            if (!parsedArgs)
+                return nullptr;
+            auto & [area] = parsedArgs->values;
+
+            const size_t count = size_t(area.size.width) * area.size.height;
+            auto numbers = py_attach(PyByteArray_FromStringAndSize(nullptr, Py_ssize_t(count * sizeof(double))));
+            if (!numbers)
+                return nullptr;
+            auto types = py_attach(PyByteArray_FromStringAndSize(nullptr, Py_ssize_t(count * sizeof(Sheet::ValueType))));
+            if (!types)
+                return nullptr;
+            std::vector<String> strings;
+            self->sheet.getValues(area, 
+                                  {reinterpret_cast<double *>(PyByteArray_AS_STRING(numbers.get())), count}, 
+                                  {reinterpret_cast<Sheet::ValueType *>(PyByteArray_AS_STRING(types.get())), count}, 
+                                  strings);
+
+            auto stringList = py_attach(PyList_New(Py_ssize_t(strings.size())));
+            if (!stringList)
+                return nullptr;
+            for (size_t i = 0; i < strings.size(); ++i) {
+                auto str = toPython(strings[i]);
+                if (!str)
+                    return nullptr;
+                PyList_SET_ITEM(stringList.get(), Py_ssize_t(i), str.release());
+            }
+            return toPython(std::tuple(std::move(numbers), std::move(types), std::move(stringList))).release();
+        EXTERNAL_EPILOG
+    }
+
     static auto getEditInfo(SheetObject * self, PyObject * args) -> PyObject * {
         EXTERNAL_PROLOG
             auto parsedArgs = parseArguments<Typelist<Spreader::Point>>(args, {"getEditInfo", {{"coordinate"}}});
@@ -662,6 +772,8 @@ PyMethodDef SheetObject::methods[] = {
     {"setFormulaCell",      (PyCFunction)setFormulaCell,        METH_VARARGS, nullptr},
     {"clearCellValue",      (PyCFunction)clearCellValue,        METH_VARARGS, nullptr},
     {"getValue",            (PyCFunction)getValue,              METH_VARARGS, nullptr},
+    {"setValues",           (PyCFunction)setValues,             METH_VARARGS, nullptr},
+    {"getValues",           (PyCFunction)getValues,             METH_VARARGS, nullptr},
     {"getEditInfo",         (PyCFunction)getEditInfo,           METH_VARARGS, nullptr},
     {"copyCell",            (PyCFunction)copyCell,              METH_VARARGS, nullptr},
     {"copyCells",           (PyCFunction)copyCells,             METH_VARARGS, nullptr},
@@ -82,6 +82,62 @@ class Sheet(object, metaclass=MetaSheet):
         the evaluated result.
         '''
         return self._impl.getValue(self._unpackPoint(coord))
+
+    def setValues(self, area: AreaCoord, values) -> None:
+        '''
+        Stores a block of scalar values into an area in one call.
+
+        `values` is anything `numpy.asarray` accepts with one element per cell
+        in row-major order - a 2D array of shape (height, width) or a flat one.
+        Numeric arrays are transferred as float64 without any per-cell
+        conversion. Other arrays are converted element by element as in
+        `setValueCell`.
+
+        Requires numpy.
+        '''
+        import numpy
+        values = numpy.asarray(values)
+        if values.dtype.kind in 'iuf':
+            values = numpy.ascontiguousarray(values, dtype=numpy.float64)
+        else:
+            values = numpy.ascontiguousarray(values, dtype=object)
+        self._impl.setValues(self._unpackArea(area), values)
+
+    def getValues(self, area: AreaCoord):
+        '''
+        Retrieves values of all cells in an area in one call.
+
+        Returns a numpy array of shape (height, width). If every cell in the area
+        holds a number the array is float64. Otherwise it is an object array of
+        the same values `getValue` would return for each cell.
+        Requires numpy.
+        '''
+        import numpy
+        x, y, width, height = self._unpackArea(area)
+        numbers, types, strings = self._impl.getValues((x, y, width, height))
+        numbers = numpy.frombuffer(numbers, dtype=numpy.float64).reshape(height, width)
+        types = numpy.frombuffer(types, dtype=numpy.uint8).reshape(height, width)
+        others = numpy.flatnonzero(types != Sheet._numberType)
+        if len(others) == 0:
+            return numbers
+        ret = numbers.astype(object)
+        flatRet, flatNumbers, flatTypes = ret.reshape(-1), numbers.reshape(-1), types.reshape(-1)
+        for idx in others:
+            flatRet[idx] = Sheet._convertValue(flatTypes[idx], flatNumbers[idx], strings)
+        return ret
+
+    #These must match Sheet::ValueType in the C++ library
+    _blankType, _boolType, _numberType, _stringType, _errorType = range(5)
+
+    @staticmethod
+    def _convertValue(type: int, number: float, strings) -> Scalar:
+        if type == Sheet._boolType:
+            return bool(number)
+        if type == Sheet._stringType:
+            return strings[int(number)]
+        if type == Sheet._errorType:
+            return ErrorValue(int(number))
+        return None
     
     def getEditInfo(self, coord: CellCoord) -> EditInfo:
         '''
@@ -0,0 +1,71 @@
+
+from eg.spreader import Sheet, Errors
+from .utils import strictEqual
+import math
+import pytest
+
+numpy = pytest.importorskip("numpy")
+
+def test_setsNumbersFromArray():
+    s = Sheet()
+    s.setValues("A1:C2", numpy.arange(6, dtype=numpy.int32).reshape(2, 3))
+    assert s.nonNullCellCount() == 6
+    assert strictEqual(s.getValue("A1"), 0.)
+    assert strictEqual(s.getValue("C1"), 2.)
+    assert strictEqual(s.getValue("A2"), 3.)
+    assert strictEqual(s.getValue("C2"), 5.)
+
+    s.setValues("A1:C1", [1.5, math.inf, math.nan])
+    assert strictEqual(s.getValue("A1"), 1.5)
+    assert s.getValue("B1") is Errors.NotANumber
+    assert s.getValue("C1") is Errors.NotANumber
+
+def test_setsMixedValuesFromArray():
+    s = Sheet()
+    s.setValues("A1:B3", numpy.array([[1, "abc"], [True, None], [Errors.InvalidValue, 2.5]], dtype=object))
+    assert s.nonNullCellCount() == 5
+    assert strictEqual(s.getValue("A1"), 1.)
+    assert strictEqual(s.getValue("B1"), "abc")
+    assert strictEqual(s.getValue("A2"), True)
+    assert strictEqual(s.getValue("B2"), None)
+    assert s.getValue("A3") is Errors.InvalidValue
+    assert strictEqual(s.getValue("B3"), 2.5)
+
+def test_rejectsMismatchedArray():
+    s = Sheet()
+    with pytest.raises(ValueError):
+        s.setValues("A1:C2", numpy.zeros((3, 2)))
+    with pytest.raises(ValueError):
+        s.setValues("A1:C2", numpy.zeros(5))
+    assert s.nonNullCellCount() == 0
+
+def test_getsNumbersAsFloatArray():
+    s = Sheet()
+    s.setValues("A1:C2", numpy.arange(6.).reshape(2, 3))
+    s.setFormulaCell("D1", "SUM(A1:C2)")
+    res = s.getValues("B1:D1")
+    assert res.dtype == numpy.float64
+    assert res.tolist() == [[1., 2., 15.]]
+
+def test_getsMixedValuesAsObjectArray():
+    s = Sheet()
+    s.setValueCell("A1", 1)
+    s.setValueCell("B1", "abc")
+    s.setValueCell("A2", False)
+    s.setFormulaCell("B2", "1/0")
+    res = s.getValues("A1:C2")
+    assert res.dtype == object
+    assert res.shape == (2, 3)
+    assert strictEqual(res[0, 0], 1.)
+    assert strictEqual(res[0, 1], "abc")
+    assert strictEqual(res[0, 2], None)
+    assert strictEqual(res[1, 0], False)
+    assert res[1, 1] is Errors.DivisionByZero
+    assert strictEqual(res[1, 2], None)
+
+def test_roundTripsLargeArray():
+    s = Sheet()
+    values = numpy.random.default_rng(1).random((1000, 100))
+    s.setValues("A1:CV1000", values)
+    assert s.nonNullCellCount() == 100000
+    assert numpy.array_equal(s.getValues("A1:CV1000"), values)